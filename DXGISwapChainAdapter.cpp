@@ -1,4 +1,9 @@
 #include "DXGISwapChainAdapter.h"
+#include "DXGISwapChainAdapterInternal.h"
+#include "PresentQueue.h"
+#include "FrameTrace.h"
+#include "SharedTextureRing.h"
+#include "VsyncEstimator.h"
 #include <SDL3/SDL_opengl.h>
 #include <cstring>
 #include <cassert>
@@ -26,25 +31,68 @@ static PFNGLGENFRAMEBUFFERSPROC glGenFramebuffers;
 static PFNGLBINDFRAMEBUFFERPROC glBindFramebuffer;
 static PFNGLFRAMEBUFFERTEXTURE2DPROC glFramebufferTexture2D;
 
+//render target views for the swapchain buffers, created once at init / resize instead of every frame
+//D3D11 flip model swapchains only let you write to buffer 0 (the runtime rotates the real buffers behind it),
+//so thats all we cache here, but its looked up by index so an api with real per-buffer indices would slot right in
+struct RenderTargetCache {
+    static const int max_buffers = 4;
+    ID3D11Texture2D* buffers[max_buffers];
+    ID3D11RenderTargetView* views[max_buffers];
+    int count;
+};
+
+struct SharedColorSlot {
+    ID3D11Texture2D* texture;
+    GLuint name;
+    HANDLE handle;
+    GLuint fbo; //one fbo per slot so switching slots is just a bind
+};
+
+//running totals as of one Present, keyed by GetLastPresentCount (the same count DXGI_FRAME_STATISTICS::PresentCount uses)
+//the refreshes between two frame statistics are checked against the sync intervals of exactly the presents in between
+struct PresentRecord {
+    bool valid;
+    UINT present_count;
+    Uint64 expected_refreshes; //sum of sync intervals
+    Uint64 unsynced_presents; //presents made with sync interval 0
+};
+
 struct DXGISwapChainAdapter {
     GLuint dsvNameGL;
-    GLuint dcbNameGL;
-    GLuint fbo;
 
     HANDLE gl_handleD3D;
     HANDLE dsvHandleGL;
-    HANDLE dcbHandleGL;
 
     ID3D11Device* device;
     ID3D11DeviceContext* devCtx;
     IDXGISwapChain* swapChain;
+    IDXGISwapChain2* swapChain2;
     HANDLE hFrameLatencyWaitableObject;
+    DXGISwapChainAdapterLatencyParams latency_params;
 
     ID3D11Texture2D* dxDepthBuffer;
-    ID3D11Texture2D* dxColorBuffer;
-    ID3D11Texture2D* dxGlColorBuffer;
-    ID3D11RenderTargetView* colorBufferView;
     ID3D11DepthStencilView* depthBufferView;
+    SharedColorSlot color_slots[SharedTextureRing::max_slots];
+    SharedTextureRing color_ring;
+
+    //every interop object GL touches in a frame, in one array so they lock and unlock with a single driver call each
+    //[0] is the depth buffer, [1] the current color slot, then the extra shared targets
+    static const int max_shared_targets = 8;
+    SharedColorSlot shared_targets[max_shared_targets];
+    int shared_target_count;
+    bool shared_target_released[max_shared_targets]; //unregistered while locked, freed by the next PrepareBuffers
+    bool shared_targets_changed; //registered / unregistered while locked, the lock list catches up in the next PrepareBuffers
+    HANDLE locked_handles[2 + max_shared_targets];
+    int locked_handle_count;
+    bool handles_locked; //between PrepareBuffers and SwapBuffers, the lock list must not change then
+    RenderTargetCache render_targets;
+    int current_buffer;
+
+    int width, height; //swapchain size
+    int target_width, target_height; //size the GL targets were allocated at, can be larger than the swapchain
+    int resize_granularity;
+    int pending_width, pending_height;
+    bool resize_pending;
 
 
     int64_t performance_frequency;
@@ -53,9 +101,23 @@ struct DXGISwapChainAdapter {
     DXGI_FRAME_STATISTICS prev_frame_stats;
     DXGI_FRAME_STATISTICS frame_stats;
     double refresh_rate;
-
-    bool is_actually_vsynced;
-    int is_vsynced_estimator;
+    DXGI_RATIONAL refresh_rate_rational;
+
+    int64_t present_block_time; //how long the last Present call took
+    int64_t wait_block_time; //how long the last wait on the frame latency object took
+    static const int present_history_length = 16; //more presents than this between two statistics reads and the count just skips them
+    PresentRecord present_history[present_history_length];
+    Uint64 expected_refreshes;
+    Uint64 unsynced_presents;
+    Uint64 missed_presents; //total refreshes that showed an old image when a new one was due
+
+    VsyncEstimator vsync_estimator;
+    int vsync_detection_grace; //frames to skip detection for after a reset, the ones already queued were presented in the old mode
+
+    //present thread mode: the wait, timing, copy and Present all move to the present thread, the main thread only does the GL side
+    //while its on, the timing fields above belong to the present thread and the getters read the published snapshot instead
+    PresentQueue* present_queue;
+    int64_t submit_block_time; //how long the main thread waited for room in the queue
 };
 
 //opengl-on-dxgi partially copied from https://github.com/nlguillemot/OpenGL-on-DXGI/blob/master/main.cpp
@@ -63,6 +125,7 @@ struct DXGISwapChainAdapter {
 //WGL_NV_DX_interop2 doesnt seem to work with sharing the back buffer directly with FLIP swapchains,
 //so instead we let openGL render to a texture, share that, then copy that to the DXGI back buffer in directx instead
 //seems to work well as a proof of concept at least
+//to keep that copy off the critical path, GL renders into a small ring of shared textures (see SharedTextureRing)
 
 void APIENTRY DebugCallbackGL(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParam) {
     OutputDebugStringA("DebugCallbackGL: ");
@@ -70,6 +133,8 @@ void APIENTRY DebugCallbackGL(GLenum source, GLenum type, GLuint id, GLenum seve
     OutputDebugStringA("\n");
 }
 
+static const UINT swap_chain_flags = DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT | DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING | DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH;
+
 bool CheckHR(HRESULT hr) {
     if(SUCCEEDED(hr)) {
         return true;
@@ -95,7 +160,7 @@ bool CheckWin32(BOOL okay) {
     return CheckHR(HRESULT_FROM_WIN32(GetLastError()));
 }
 
-HRESULT GetRefreshRate(IUnknown* device, IDXGISwapChain* swapChain, double* outRefreshRate) {
+HRESULT GetRefreshRate(IUnknown* device, IDXGISwapChain* swapChain, DXGI_RATIONAL* outRefreshRate) {
     IDXGIOutput* dxgiOutput;
     HRESULT hr = swapChain->GetContainingOutput(&dxgiOutput);
     if(FAILED(hr))
@@ -104,14 +169,163 @@ HRESULT GetRefreshRate(IUnknown* device, IDXGISwapChain* swapChain, double* outR
     DXGI_MODE_DESC emptyMode = {};
     DXGI_MODE_DESC modeDescription;
     hr = dxgiOutput->FindClosestMatchingMode(&emptyMode, &modeDescription, device);
+    dxgiOutput->Release();
 
-    if(SUCCEEDED(hr))
-        *outRefreshRate = (double)modeDescription.RefreshRate.Numerator / (double)modeDescription.RefreshRate.Denominator;
+    if(SUCCEEDED(hr) && modeDescription.RefreshRate.Denominator != 0)
+        *outRefreshRate = modeDescription.RefreshRate;
 
     return hr;
 }
 
-DXGISwapChainAdapter* CreateDXGISwapChainAdapter(SDL_Window* window) {
+//views for the first count swapchain buffers, stops at the first failure with the ones made so far in the cache
+static HRESULT create_render_target_cache(ID3D11Device* device, IDXGISwapChain* swapChain, int count, RenderTargetCache* cache) {
+    memset(cache, 0, sizeof(RenderTargetCache));
+    if(count > cache->max_buffers) count = cache->max_buffers;
+
+    CD3D11_RENDER_TARGET_VIEW_DESC rtvdesc = CD3D11_RENDER_TARGET_VIEW_DESC(D3D11_RTV_DIMENSION_TEXTURE2D, DXGI_FORMAT_R8G8B8A8_UNORM);
+    for(int i = 0; i < count; i++) {
+        HRESULT hr = swapChain->GetBuffer(i, __uuidof(ID3D11Texture2D), (LPVOID*)&cache->buffers[i]);
+        if(SUCCEEDED(hr)) hr = device->CreateRenderTargetView(cache->buffers[i], &rtvdesc, &cache->views[i]);
+        if(FAILED(hr)) return hr;
+        cache->count = i+1;
+    }
+    return S_OK;
+}
+
+static void release_render_target_cache(RenderTargetCache* cache) {
+    for(int i = 0; i < cache->max_buffers; i++) {
+        if(cache->views[i]) cache->views[i]->Release();
+        if(cache->buffers[i]) cache->buffers[i]->Release();
+    }
+    memset(cache, 0, sizeof(RenderTargetCache));
+}
+
+static void rebuild_lock_list(DXGISwapChainAdapter* context) {
+    context->locked_handles[0] = context->dsvHandleGL;
+    context->locked_handles[1] = context->color_slots[context->color_ring.render_slot].handle;
+    for(int i = 0; i < context->shared_target_count; i++) {
+        context->locked_handles[2 + i] = context->shared_targets[i].handle;
+    }
+    context->locked_handle_count = 2 + context->shared_target_count;
+}
+
+//frees the shared targets unregistered since the last change and rebuilds the lock list, only while nothing is locked
+static void apply_shared_target_changes(DXGISwapChainAdapter* context) {
+    int kept = 0;
+    for(int i = 0; i < context->shared_target_count; i++) {
+        SharedColorSlot* target = &context->shared_targets[i];
+        if(context->shared_target_released[i]) {
+            wglDXUnregisterObjectNV(context->gl_handleD3D, target->handle);
+            glDeleteTextures(1, &target->name);
+            target->texture->Release();
+            context->shared_target_released[i] = false;
+            continue;
+        }
+        context->shared_targets[kept++] = *target;
+    }
+    context->shared_target_count = kept;
+    context->shared_targets_changed = false;
+    rebuild_lock_list(context);
+}
+
+//everything that has to be recreated when the size changes: the depth buffer and the shared color ring, registered with GL
+static void create_interop_targets(DXGISwapChainAdapter* context, int width, int height) {
+    // Create depth stencil texture
+    CD3D11_TEXTURE2D_DESC dstdesc = CD3D11_TEXTURE2D_DESC(DXGI_FORMAT_R32G8X24_TYPELESS, width, height, 1, 1, D3D11_BIND_DEPTH_STENCIL);
+    CheckHR(context->device->CreateTexture2D(
+        &dstdesc,
+        NULL,
+        &context->dxDepthBuffer));
+
+    // Create depth stencil view
+    CD3D11_DEPTH_STENCIL_VIEW_DESC dsvdesc = CD3D11_DEPTH_STENCIL_VIEW_DESC(D3D11_DSV_DIMENSION_TEXTURE2D, DXGI_FORMAT_D32_FLOAT_S8X24_UINT);
+    CheckHR(context->device->CreateDepthStencilView(
+        context->dxDepthBuffer,
+        &dsvdesc,
+        &context->depthBufferView));
+
+    // register the Direct3D depth/stencil buffer as texture2d in opengl
+    context->dsvHandleGL = wglDXRegisterObjectNV(context->gl_handleD3D, context->dxDepthBuffer, context->dsvNameGL, GL_TEXTURE_2D, WGL_ACCESS_READ_WRITE_NV);
+    CheckWin32(context->dsvHandleGL != NULL);
+
+    for(int i = 0; i < context->color_ring.count; i++) {
+        SharedColorSlot* slot = &context->color_slots[i];
+
+        // Create color buffer texture
+        CD3D11_TEXTURE2D_DESC dgldesc = CD3D11_TEXTURE2D_DESC(DXGI_FORMAT_R8G8B8A8_UNORM, width, height, 1, 1, D3D11_BIND_RENDER_TARGET);
+        CheckHR(context->device->CreateTexture2D(
+            &dgldesc,
+            NULL,
+            &slot->texture));
+
+        //register color buffer as a texture2D in opengl
+        slot->handle = wglDXRegisterObjectNV(context->gl_handleD3D, slot->texture, slot->name, GL_TEXTURE_2D, WGL_ACCESS_READ_WRITE_NV);
+        CheckWin32(slot->handle != NULL);
+
+        // attach the Direct3D depth buffer and this color slot to its FBO
+        glBindFramebuffer(GL_FRAMEBUFFER, slot->fbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, context->dsvNameGL, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, slot->name, 0);
+    }
+
+    rebuild_lock_list(context);
+}
+
+static void release_interop_targets(DXGISwapChainAdapter* context) {
+    //release linked opengl resources
+    wglDXUnregisterObjectNV(context->gl_handleD3D, context->dsvHandleGL);
+    for(int i = 0; i < context->color_ring.count; i++) {
+        wglDXUnregisterObjectNV(context->gl_handleD3D, context->color_slots[i].handle);
+    }
+
+    //release directx resources
+    context->depthBufferView->Release();
+    context->dxDepthBuffer->Release();
+    for(int i = 0; i < context->color_ring.count; i++) {
+        context->color_slots[i].texture->Release();
+    }
+}
+
+DXGISwapChainAdapterLatencyParams DXGISwapChainAdapterGetLatencyParams(DXGISwapChainAdapterLatencyMode latency_mode) {
+    DXGISwapChainAdapterLatencyParams params;
+    switch(latency_mode) {
+    case DXGI_SWAPCHAIN_LATENCY_BALANCED:
+        params.buffer_count = 3;
+        params.max_frame_latency = 1;
+        break;
+    case DXGI_SWAPCHAIN_LATENCY_THROUGHPUT:
+        params.buffer_count = 3;
+        params.max_frame_latency = 2;
+        break;
+    default:
+        params.buffer_count = 2;
+        params.max_frame_latency = 1;
+        break;
+    }
+    return params;
+}
+
+HRESULT DXGISwapChainAdapterApplyLatencyParams(const DXGISwapChainLatencyOps* ops, const DXGISwapChainAdapterLatencyParams* current, const DXGISwapChainAdapterLatencyParams* params) {
+    if(current->buffer_count != params->buffer_count) {
+        HRESULT hr = ops->resize_buffers(ops->user_data, params->buffer_count);
+        if(FAILED(hr)) return hr;
+    }
+    //ResizeBuffers leaves the frame latency alone, so an unchanged one needs no call either
+    if(current->max_frame_latency != params->max_frame_latency) return ops->set_maximum_frame_latency(ops->user_data, params->max_frame_latency);
+    return S_OK;
+}
+
+static HRESULT resize_swapchain_buffers(void* user_data, unsigned int buffer_count) {
+    DXGISwapChainAdapter* context = (DXGISwapChainAdapter*)user_data;
+    return context->swapChain->ResizeBuffers(buffer_count, 0, 0, DXGI_FORMAT_UNKNOWN, swap_chain_flags); //0 width / height keeps the current size
+}
+
+static HRESULT set_swapchain_frame_latency(void* user_data, unsigned int max_frame_latency) {
+    DXGISwapChainAdapter* context = (DXGISwapChainAdapter*)user_data;
+    return context->swapChain2->SetMaximumFrameLatency(max_frame_latency);
+}
+
+DXGISwapChainAdapter* CreateDXGISwapChainAdapter(SDL_Window* window, DXGISwapChainAdapterLatencyMode latency_mode) {
     //from experiments, we don't actually need to create the GL context ourselves, we can use the one SDL made, which simplifies this a bit (can float on top of an existing context)
 
     DXGISwapChainAdapter* res = (DXGISwapChainAdapter*)malloc(sizeof(DXGISwapChainAdapter));
@@ -138,15 +352,17 @@ DXGISwapChainAdapter* CreateDXGISwapChainAdapter(SDL_Window* window) {
     glBindFramebuffer = (PFNGLBINDFRAMEBUFFERPROC)wglGetProcAddress("glBindFramebuffer");
     glFramebufferTexture2D = (PFNGLFRAMEBUFFERTEXTURE2DPROC)wglGetProcAddress("glFramebufferTexture2D");
 
+    res->latency_params = DXGISwapChainAdapterGetLatencyParams(latency_mode);
+
     DXGI_SWAP_CHAIN_DESC scd = {};
     scd.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
     scd.SampleDesc.Count = 1;
-    scd.BufferCount = 2; //double buffer
+    scd.BufferCount = res->latency_params.buffer_count; //double or triple buffer
     scd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
     scd.OutputWindow = hWnd;
     scd.Windowed = TRUE;
     scd.SwapEffect = DXGI_SWAP_EFFECT_FLIP_SEQUENTIAL;
-    scd.Flags = DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT | DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING | DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH;
+    scd.Flags = swap_chain_flags;
 
     UINT flags = 0;
 #if _DEBUG
@@ -171,111 +387,147 @@ DXGISwapChainAdapter* CreateDXGISwapChainAdapter(SDL_Window* window) {
     CheckWin32(res->gl_handleD3D != NULL);
 
     // get frame latency waitable object
-    IDXGISwapChain2* swapChain2;
-    CheckHR(res->swapChain->QueryInterface(&swapChain2));
-    res->hFrameLatencyWaitableObject = swapChain2->GetFrameLatencyWaitableObject();
+    CheckHR(res->swapChain->QueryInterface(&res->swapChain2));
+    CheckHR(res->swapChain2->SetMaximumFrameLatency(res->latency_params.max_frame_latency));
+    res->hFrameLatencyWaitableObject = res->swapChain2->GetFrameLatencyWaitableObject();
 
-    // Create depth stencil texture
-    CD3D11_TEXTURE2D_DESC dstdesc = CD3D11_TEXTURE2D_DESC(DXGI_FORMAT_R32G8X24_TYPELESS, width, height, 1, 1, D3D11_BIND_DEPTH_STENCIL);
-    CheckHR(res->device->CreateTexture2D(
-        &dstdesc,
-        NULL,
-        &res->dxDepthBuffer));
-
-    // Create depth stencil view
-    CD3D11_DEPTH_STENCIL_VIEW_DESC dsvdesc = CD3D11_DEPTH_STENCIL_VIEW_DESC(D3D11_DSV_DIMENSION_TEXTURE2D, DXGI_FORMAT_D32_FLOAT_S8X24_UINT);
-    CheckHR(res->device->CreateDepthStencilView(
-        res->dxDepthBuffer,
-        &dsvdesc,
-        &res->depthBufferView));
-
-    // Create color buffer texture
-    CD3D11_TEXTURE2D_DESC dgldesc = CD3D11_TEXTURE2D_DESC(DXGI_FORMAT_R8G8B8A8_UNORM, width, height, 1, 1, D3D11_BIND_RENDER_TARGET);
-    CheckHR(res->device->CreateTexture2D(
-        &dgldesc,
-        NULL,
-        &res->dxGlColorBuffer));
+    // Create the backbuffer render target views once, only buffer 0 is writable with a D3D11 flip swapchain
+    CheckHR(create_render_target_cache(res->device, res->swapChain, 1, &res->render_targets));
 
-    // register the Direct3D depth/stencil buffer as texture2d in opengl
+    // GL names for the shared depth buffer and the color ring, these survive resizes
     glGenTextures(1, &res->dsvNameGL);
-    res->dsvHandleGL = wglDXRegisterObjectNV(res->gl_handleD3D, res->dxDepthBuffer, res->dsvNameGL, GL_TEXTURE_2D, WGL_ACCESS_READ_WRITE_NV);
-    CheckWin32(res->dsvHandleGL != NULL);
-
-    //register color buffer as a texture2D in opengl
-    glGenTextures(1, &res->dcbNameGL);
-    res->dcbHandleGL = wglDXRegisterObjectNV(res->gl_handleD3D, res->dxGlColorBuffer, res->dcbNameGL, GL_TEXTURE_2D, WGL_ACCESS_READ_WRITE_NV);
-    CheckWin32(res->dcbHandleGL != NULL);
+    SharedTextureRingInit(&res->color_ring, 2);
+    for(int i = 0; i < res->color_ring.count; i++) {
+        glGenTextures(1, &res->color_slots[i].name);
+        glGenFramebuffers(1, &res->color_slots[i].fbo);
+    }
 
-    // attach the Direct3D depth buffer to FBO
-    glGenFramebuffers(1, &res->fbo);
-    glBindFramebuffer(GL_FRAMEBUFFER, res->fbo);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, res->dsvNameGL, 0);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, res->dcbNameGL, 0);
+    create_interop_targets(res, width, height);
+    res->width = res->target_width = width;
+    res->height = res->target_height = height;
 
-    CheckHR(GetRefreshRate(res->device, res->swapChain, &res->refresh_rate));
+    res->refresh_rate_rational.Numerator = 60; //fallback if the output cant tell us
+    res->refresh_rate_rational.Denominator = 1;
+    CheckHR(GetRefreshRate(res->device, res->swapChain, &res->refresh_rate_rational));
+    res->refresh_rate = (double)res->refresh_rate_rational.Numerator / res->refresh_rate_rational.Denominator;
 
     LARGE_INTEGER freq;
     QueryPerformanceFrequency(&freq);
     res->performance_frequency = freq.QuadPart;
 
-    res->is_actually_vsynced = true; //initial guess should be to assume we are vsynced
+    VsyncEstimatorConfig estimator_config = VsyncEstimatorDefaultConfigDXGI();
+    VsyncEstimatorInit(&res->vsync_estimator, &estimator_config, true); //initial guess should be to assume we are vsynced
 
     return res;
 }
 
+//anything that touches state the present thread uses has to wait for it to go idle first
+static void wait_for_present_thread(DXGISwapChainAdapter* context) {
+    if(context->present_queue) PresentQueueDrain(context->present_queue);
+}
+
 double DXGISwapChainAdapterRefreshRate(DXGISwapChainAdapter* context) {
     return context->refresh_rate;
 }
 
+void DXGISwapChainAdapterRefreshRateRational(DXGISwapChainAdapter* context, int64_t* numerator, int64_t* denominator) {
+    *numerator = context->refresh_rate_rational.Numerator;
+    *denominator = context->refresh_rate_rational.Denominator;
+}
+
+bool DXGISwapChainAdapterUpdateRefreshRate(DXGISwapChainAdapter* context) {
+    //the containing output changes when the window moves to another monitor, so just ask again
+    DXGI_RATIONAL rate = context->refresh_rate_rational;
+    if(FAILED(GetRefreshRate(context->device, context->swapChain, &rate))) return false;
+
+    //compare as fractions, 120/1 and 240/2 are the same rate
+    if((uint64_t)rate.Numerator * context->refresh_rate_rational.Denominator == (uint64_t)context->refresh_rate_rational.Numerator * rate.Denominator) return false;
+
+    DXGISwapChainAdapterSetRefreshRate(context, rate.Numerator, rate.Denominator);
+    return true;
+}
+
 void DXGISwapChainAdapterResize(DXGISwapChainAdapter* context, int width, int height) {
-    //release linked opengl resources
-    wglDXUnregisterObjectNV(context->gl_handleD3D, context->dsvHandleGL);
-    wglDXUnregisterObjectNV(context->gl_handleD3D, context->dcbHandleGL);
+    //a window drag sends dozens of these per frame (and SDL sends both RESIZED and PIXEL_SIZE_CHANGED), only the last one matters
+    context->pending_width = width;
+    context->pending_height = height;
+    context->resize_pending = true;
+}
 
-    context->devCtx->OMSetRenderTargets(0, NULL, NULL);
+void DXGISwapChainAdapterSetResizeGranularity(DXGISwapChainAdapter* context, int granularity) {
+    context->resize_granularity = granularity;
+}
 
-    //release directx resourcers
-    context->depthBufferView->Release();
-    context->dxDepthBuffer->Release();
-    context->dxGlColorBuffer->Release();
+static int round_up_to_granularity(int size, int granularity) {
+    if(granularity <= 0) return size;
+    return (size + granularity - 1) / granularity * granularity;
+}
 
-    //resize the swap chain
-    CheckHR(context->swapChain->ResizeBuffers(2, width, height, DXGI_FORMAT_UNKNOWN, DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT | DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING | DXGI_SWAP_CHAIN_FLAG_ALLOW_MODE_SWITCH));
+static void apply_pending_resize(DXGISwapChainAdapter* context) {
+    context->resize_pending = false;
+    int width = context->pending_width;
+    int height = context->pending_height;
+    if(width <= 0 || height <= 0) return; //minimized
+    if(width == context->width && height == context->height) return;
 
-    //recreate directx resources
-    // Create depth stencil texture
-    CD3D11_TEXTURE2D_DESC dstdesc = CD3D11_TEXTURE2D_DESC(DXGI_FORMAT_R32G8X24_TYPELESS, width, height, 1, 1, D3D11_BIND_DEPTH_STENCIL);
-    CheckHR(context->device->CreateTexture2D(
-        &dstdesc,
-        NULL,
-        &context->dxDepthBuffer));
+    context->devCtx->OMSetRenderTargets(0, NULL, NULL);
 
-    // Create depth stencil view
-    CD3D11_DEPTH_STENCIL_VIEW_DESC dsvdesc = CD3D11_DEPTH_STENCIL_VIEW_DESC(D3D11_DSV_DIMENSION_TEXTURE2D, DXGI_FORMAT_D32_FLOAT_S8X24_UINT);
-    CheckHR(context->device->CreateDepthStencilView(
-        context->dxDepthBuffer,
-        &dsvdesc,
-        &context->depthBufferView));
+    //the GL targets only need to be rebuilt when the new size leaves the band they were allocated for
+    //(bigger than the allocation, or small enough that we are wasting more than a granularity step of memory)
+    int granularity = context->resize_granularity;
+    bool realloc_targets = width > context->target_width || height > context->target_height
+        || round_up_to_granularity(width, granularity) < context->target_width - granularity
+        || round_up_to_granularity(height, granularity) < context->target_height - granularity
+        || (granularity <= 0 && (width != context->target_width || height != context->target_height));
+    if(realloc_targets) release_interop_targets(context);
+    release_render_target_cache(&context->render_targets);
+
+    //resize the swap chain, this always has to match the window or DXGI will scale the image
+    CheckHR(context->swapChain->ResizeBuffers(context->latency_params.buffer_count, width, height, DXGI_FORMAT_UNKNOWN, swap_chain_flags));
+    CheckHR(create_render_target_cache(context->device, context->swapChain, 1, &context->render_targets));
+    context->width = width;
+    context->height = height;
+
+    //recreate directx resources and reregister them with opengl
+    if(realloc_targets) {
+        context->target_width = round_up_to_granularity(width, granularity);
+        context->target_height = round_up_to_granularity(height, granularity);
+        create_interop_targets(context, context->target_width, context->target_height);
+    }
+}
 
-    // Create color buffer texture
-    CD3D11_TEXTURE2D_DESC dgldesc = CD3D11_TEXTURE2D_DESC(DXGI_FORMAT_R8G8B8A8_UNORM, width, height, 1, 1, D3D11_BIND_RENDER_TARGET);
-    CheckHR(context->device->CreateTexture2D(
-        &dgldesc,
-        NULL,
-        &context->dxGlColorBuffer));
+void DXGISwapChainAdapterSetLatencyMode(DXGISwapChainAdapter* context, DXGISwapChainAdapterLatencyMode latency_mode) {
+    DXGISwapChainAdapterLatencyParams params = DXGISwapChainAdapterGetLatencyParams(latency_mode);
+    wait_for_present_thread(context);
+    context->devCtx->OMSetRenderTargets(0, NULL, NULL);
+    release_render_target_cache(&context->render_targets);
+    DXGISwapChainLatencyOps ops = { resize_swapchain_buffers, set_swapchain_frame_latency, context };
+    if(CheckHR(DXGISwapChainAdapterApplyLatencyParams(&ops, &context->latency_params, &params))) {
+        context->latency_params = params;
+    }
+    CheckHR(create_render_target_cache(context->device, context->swapChain, 1, &context->render_targets));
+}
 
-    //reregister the buffers with opengl
-    context->dsvHandleGL = wglDXRegisterObjectNV(context->gl_handleD3D, context->dxDepthBuffer, context->dsvNameGL, GL_TEXTURE_2D, WGL_ACCESS_READ_WRITE_NV);
-    CheckWin32(context->dsvHandleGL != NULL);
+int DXGISwapChainAdapterGetFrameLatency(DXGISwapChainAdapter* context) {
+    return context->latency_params.max_frame_latency;
+}
 
-    //register color buffer as a texture2D in opengl
-    context->dcbHandleGL = wglDXRegisterObjectNV(context->gl_handleD3D, context->dxGlColorBuffer, context->dcbNameGL, GL_TEXTURE_2D, WGL_ACCESS_READ_WRITE_NV);
-    CheckWin32(context->dcbHandleGL != NULL);
+static void record_present(DXGISwapChainAdapter* context, int sync_interval) {
+    context->expected_refreshes += sync_interval;
+    if(sync_interval == 0) context->unsynced_presents++;
+
+    UINT present_count;
+    if(FAILED(context->swapChain->GetLastPresentCount(&present_count))) return;
+    PresentRecord* record = &context->present_history[present_count % DXGISwapChainAdapter::present_history_length];
+    record->valid = true;
+    record->present_count = present_count;
+    record->expected_refreshes = context->expected_refreshes;
+    record->unsynced_presents = context->unsynced_presents;
+}
 
-    // reattach the Direct3D depth buffer to FBO
-    glBindFramebuffer(GL_FRAMEBUFFER, context->fbo);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_TEXTURE_2D, context->dsvNameGL, 0);
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, context->dcbNameGL, 0);
+static const PresentRecord* find_present_record(DXGISwapChainAdapter* context, UINT present_count) {
+    const PresentRecord* record = &context->present_history[present_count % DXGISwapChainAdapter::present_history_length];
+    return record->valid && record->present_count == present_count?record:NULL;
 }
 
 static void update_timing_information(DXGISwapChainAdapter* context) {
@@ -290,12 +542,20 @@ static void update_timing_information(DXGISwapChainAdapter* context) {
 
     int64_t monitor_period = context->performance_frequency / context->refresh_rate;
 
-    //i dont know whether to use present refresh count or sync refresh count here, whats the difference?
-    int missed_presents = (context->frame_stats.PresentRefreshCount - context->prev_frame_stats.PresentRefreshCount) - (context->frame_stats.PresentCount - context->prev_frame_stats.PresentCount);
-
     //before any frames are pushed, this reports 0, we wanna wait till we got real information before doing vsync detection
     if(context->frame_stats.SyncQPCTime.QuadPart == 0 || context->prev_frame_stats.SyncQPCTime.QuadPart == 0) return;
 
+    //i dont know whether to use present refresh count or sync refresh count here, whats the difference?
+    //every present asked for its own sync_interval refreshes, any refresh beyond their sum kept showing the previous image because the next one wasnt ready
+    //without vsync nothing waits for a refresh, so a range with an unsynced present in it cant have missed any either
+    const PresentRecord* first = find_present_record(context, context->prev_frame_stats.PresentCount);
+    const PresentRecord* last = find_present_record(context, context->frame_stats.PresentCount);
+    if(first && last && last->unsynced_presents == first->unsynced_presents) {
+        int refreshes = context->frame_stats.PresentRefreshCount - context->prev_frame_stats.PresentRefreshCount;
+        int missed_presents = refreshes - (int)(last->expected_refreshes - first->expected_refreshes);
+        if(missed_presents > 0) context->missed_presents += missed_presents;
+    }
+
     //difference between measured time and refresh time after waiting on the latency object
     //if we are vsynced and not missing frames, this is close to 0
     //if we are missing frames, this is close to a vsync multiple, however it doesnt appear to be that correlated with the number of missed presents
@@ -304,86 +564,255 @@ static void update_timing_information(DXGISwapChainAdapter* context) {
     int64_t expected_delta = monitor_period * snapval;
     //int64_t expected_delta = missed_presents * (context->performance_frequency/context->refresh_rate); (this seems to only be true ~80 of the time if we are missing frames, so check to snapped vals instead)
 
-    bool was_previous_frame_synced = abs(latency_delta - expected_delta) < .0001 * context->performance_frequency * (snapval+1);
-    bool definitely_not_vsynced = context->prev_frame_stats.PresentCount == context->frame_stats.PresentCount;
+    if(context->vsync_detection_grace > 0) {
+        context->vsync_detection_grace--;
+        return;
+    }
 
-    if(context->is_actually_vsynced) {
-        context->is_vsynced_estimator += was_previous_frame_synced?-1:1;
-        if(context->is_vsynced_estimator < 0) context->is_vsynced_estimator = 0;
-        if(context->is_vsynced_estimator >= 4) { //net +4 unsynced frames, we aren't vsynced
-            context->is_vsynced_estimator = 0;
-            context->is_actually_vsynced = false;
-        }
-    } else {
-        context->is_vsynced_estimator += was_previous_frame_synced?1:-1;
-        if(context->is_vsynced_estimator < 0 || definitely_not_vsynced) context->is_vsynced_estimator = 0;
-        if(context->is_vsynced_estimator >= 8) { //net +8 vsynced frames, we are probably vsynced
-            context->is_vsynced_estimator = 0;
-            context->is_actually_vsynced = true;
-        }
+    double clocks = context->performance_frequency;
+    VsyncEstimatorSample sample;
+    sample.error = (latency_delta - expected_delta) / clocks;
+    sample.tolerance_scale = snapval+1;
+    sample.residual = sample.error;
+    sample.refresh_period = monitor_period / clocks;
+    sample.definitely_not_vsynced = context->prev_frame_stats.PresentCount == context->frame_stats.PresentCount;
+    VsyncEstimatorUpdate(&context->vsync_estimator, &sample);
+}
+
+unsigned int DXGISwapChainAdapterRegisterSharedTarget(DXGISwapChainAdapter* context, int width, int height) {
+    if(context->shared_target_count >= context->max_shared_targets) return 0;
+    SharedColorSlot* target = &context->shared_targets[context->shared_target_count];
+    memset(target, 0, sizeof(SharedColorSlot));
+
+    CD3D11_TEXTURE2D_DESC desc = CD3D11_TEXTURE2D_DESC(DXGI_FORMAT_R8G8B8A8_UNORM, width, height, 1, 1, D3D11_BIND_RENDER_TARGET | D3D11_BIND_SHADER_RESOURCE);
+    if(!CheckHR(context->device->CreateTexture2D(&desc, NULL, &target->texture))) return 0;
+
+    glGenTextures(1, &target->name);
+    target->handle = wglDXRegisterObjectNV(context->gl_handleD3D, target->texture, target->name, GL_TEXTURE_2D, WGL_ACCESS_READ_WRITE_NV);
+    if(!CheckWin32(target->handle != NULL)) {
+        target->texture->Release();
+        return 0;
     }
+
+    context->shared_target_count++;
+    context->shared_targets_changed = true;
+    if(!context->handles_locked) apply_shared_target_changes(context);
+    return target->name;
+}
+
+bool DXGISwapChainAdapterUnregisterSharedTarget(DXGISwapChainAdapter* context, unsigned int name) {
+    for(int i = 0; i < context->shared_target_count; i++) {
+        if(context->shared_targets[i].name != name || context->shared_target_released[i]) continue;
+        context->shared_target_released[i] = true;
+        context->shared_targets_changed = true;
+        if(!context->handles_locked) apply_shared_target_changes(context);
+        return true;
+    }
+    return false;
 }
 
 void DXGISwapChainAdapterPrepareBuffers(DXGISwapChainAdapter* context) {
-    // Wait for swap chain to signal that it is ready to render
-    CheckWin32(WaitForSingleObject(context->hFrameLatencyWaitableObject, INFINITE) == WAIT_OBJECT_0);
+    if(context->resize_pending) {
+        wait_for_present_thread(context);
+        apply_pending_resize(context);
+    }
 
-    update_timing_information(context);
-    
+    //with a present thread, it does the wait right before presenting, we only need a free slot in the ring (SwapBuffers made sure of that)
+    if(!context->present_queue) {
+        LARGE_INTEGER wait_start;
+        QueryPerformanceCounter(&wait_start);
 
-    // Fetch the current swapchain backbuffer from the FLIP swap chain
-    CheckHR(context->swapChain->GetBuffer(0, __uuidof(ID3D11Texture2D), (LPVOID*)&context->dxColorBuffer));
+        // Wait for swap chain to signal that it is ready to render
+        CheckWin32(WaitForSingleObject(context->hFrameLatencyWaitableObject, INFINITE) == WAIT_OBJECT_0);
 
-    // Create RTV for swapchain backbuffer
-    CD3D11_RENDER_TARGET_VIEW_DESC rtvdesc = CD3D11_RENDER_TARGET_VIEW_DESC(D3D11_RTV_DIMENSION_TEXTURE2D, DXGI_FORMAT_R8G8B8A8_UNORM);
-    CheckHR(context->device->CreateRenderTargetView(
-        context->dxColorBuffer,
-        &rtvdesc,
-        &context->colorBufferView));
+        update_timing_information(context);
+        context->wait_block_time = context->swap_timestamp - wait_start.QuadPart;
+        
 
-    // Attach back buffer and depth texture to redertarget for the device.
-    context->devCtx->OMSetRenderTargets(1, &context->colorBufferView, context->depthBufferView);
+        // Pick the cached view for the current backbuffer (always 0 for a D3D11 FLIP swap chain)
+        context->current_buffer = 0;
 
-    // lock the dsv/rtv for GL access
-    wglDXLockObjectsNV(context->gl_handleD3D, 1, &context->dsvHandleGL);
-    wglDXLockObjectsNV(context->gl_handleD3D, 1, &context->dcbHandleGL);
+        // Attach back buffer and depth texture to redertarget for the device.
+        context->devCtx->OMSetRenderTargets(1, &context->render_targets.views[context->current_buffer], context->depthBufferView);
+    }
+
+    // GL renders into the next slot of the ring, while the previous one may still be copying
+    SharedColorSlot* slot = &context->color_slots[SharedTextureRingAcquire(&context->color_ring)];
+
+    // lock the dsv/rtv (and any extra shared targets) for GL access, in one call
+    if(context->shared_targets_changed) apply_shared_target_changes(context);
+    context->locked_handles[1] = slot->handle;
+    wglDXLockObjectsNV(context->gl_handleD3D, context->locked_handle_count, context->locked_handles);
+    context->handles_locked = true;
 
     //bind opengl frame buffer
-    glBindFramebuffer(GL_FRAMEBUFFER, context->fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, slot->fbo);
+}
+
+//the D3D half of a swap, runs on whichever thread presents
+static void copy_and_present(DXGISwapChainAdapter* context, SharedColorSlot* slot, int sync_interval) {
+    //copy opengl framebuffer to swapchain framebuffer, this runs on the gpu while GL moves on to the next slot
+    ID3D11Texture2D* backbuffer = context->render_targets.buffers[context->current_buffer];
+    if(context->target_width == context->width && context->target_height == context->height) {
+        context->devCtx->CopyResource(backbuffer, slot->texture);
+    } else {
+        //over-allocated GL target, GL rendered into the top left corner (in D3D terms)
+        D3D11_BOX box = { 0, 0, 0, (UINT)context->width, (UINT)context->height, 1 };
+        context->devCtx->CopySubresourceRegion(backbuffer, 0, 0, 0, 0, slot->texture, 0, &box);
+    }
+
+    LARGE_INTEGER present_start, present_end;
+    QueryPerformanceCounter(&present_start);
+    CheckHR(context->swapChain->Present(sync_interval, sync_interval>0?0:DXGI_PRESENT_ALLOW_TEARING));
+    QueryPerformanceCounter(&present_end);
+    FrameTraceMarker("present", present_start.QuadPart);
+    context->present_block_time = present_end.QuadPart - present_start.QuadPart;
+    record_present(context, sync_interval);
 }
 
 void DXGISwapChainAdapterSwapBuffers(DXGISwapChainAdapter* context, int sync_interval) {
-    // unlock the dsv/rtv
-    wglDXUnlockObjectsNV(context->gl_handleD3D, 1, &context->dcbHandleGL);
-    wglDXUnlockObjectsNV(context->gl_handleD3D, 1, &context->dsvHandleGL);
+    int slot_index = SharedTextureRingSubmit(&context->color_ring);
 
-    //copy opengl framebuffer to swapchain framebuffer
-    context->devCtx->CopyResource(context->dxColorBuffer, context->dxGlColorBuffer);
+    // unlock everything we locked in PrepareBuffers, in one call
+    wglDXUnlockObjectsNV(context->gl_handleD3D, context->locked_handle_count, context->locked_handles);
+    context->handles_locked = false;
 
-    CheckHR(context->swapChain->Present(sync_interval, sync_interval>0?0:DXGI_PRESENT_ALLOW_TEARING));
+    if(context->present_queue) {
+        //blocks while the queue is full, which also guarantees the slot we render into next isnt still being copied
+        PresentQueueFrame frame = { slot_index, sync_interval };
+        context->submit_block_time = PresentQueueSubmit(context->present_queue, &frame);
+        return;
+    }
+    copy_and_present(context, &context->color_slots[slot_index], sync_interval);
+}
+
+//what the getters see while the present thread is on, written after each of its presents and once when it starts
+static void fill_present_thread_timings(DXGISwapChainAdapter* context, PresentQueueTimings* timings) {
+    bool vsynced = context->vsync_estimator.is_vsynced;
+    timings->present_timestamp = vsynced?context->frame_stats.SyncQPCTime.QuadPart:context->swap_timestamp;
+    timings->sync_time = context->frame_stats.SyncQPCTime.QuadPart;
+    timings->present_count = context->frame_stats.PresentCount;
+    timings->present_refresh_count = context->frame_stats.PresentRefreshCount;
+    timings->sync_refresh_count = context->frame_stats.SyncRefreshCount;
+    timings->present_block_time = context->present_block_time;
+    timings->wait_block_time = context->wait_block_time;
+    timings->timing_method_delta = context->swap_timestamp - context->frame_stats.SyncQPCTime.QuadPart;
+    timings->vsynced = vsynced;
+    timings->missed_presents = context->missed_presents;
+}
+
+//present thread side of a frame, same order as the synchronous path: wait for the latency object, read the timings, copy, present
+static void present_thread_frame(const PresentQueueFrame* frame, PresentQueueTimings* timings, void* user_data) {
+    DXGISwapChainAdapter* context = (DXGISwapChainAdapter*)user_data;
+
+    LARGE_INTEGER wait_start;
+    QueryPerformanceCounter(&wait_start);
+    CheckWin32(WaitForSingleObject(context->hFrameLatencyWaitableObject, INFINITE) == WAIT_OBJECT_0);
+    update_timing_information(context);
+    context->wait_block_time = context->swap_timestamp - wait_start.QuadPart;
+
+    context->current_buffer = 0;
+    copy_and_present(context, &context->color_slots[frame->slot], frame->sync_interval);
+    fill_present_thread_timings(context, timings);
+}
+
+void DXGISwapChainAdapterSetPresentThread(DXGISwapChainAdapter* context, bool enabled) {
+    if(enabled == (context->present_queue != NULL)) return;
+
+    if(!enabled) {
+        DestroyPresentQueue(context->present_queue);
+        context->present_queue = NULL;
+        return;
+    }
+
+    //GL locks interop objects from the main thread while the present thread copies, both go through the immediate context
+    ID3D11Multithread* multithread = NULL;
+    if(SUCCEEDED(context->devCtx->QueryInterface(&multithread))) {
+        multithread->SetMultithreadProtected(TRUE);
+        multithread->Release();
+    }
+    context->devCtx->OMSetRenderTargets(0, NULL, NULL);
+
+    //one frame in flight per spare ring slot, so GL never renders into a slot the present thread is copying
+    context->present_queue = CreatePresentQueue(context->color_ring.count - 1, present_thread_frame, context);
+
+    //until its first present the getters read the snapshot, start it from what the synchronous path measured last instead of zeros
+    PresentQueueTimings timings;
+    memset(&timings, 0, sizeof(timings));
+    fill_present_thread_timings(context, &timings);
+    PresentQueuePublishTimings(context->present_queue, &timings);
+}
 
-    //release current backbuffer back to the swap chain
-    context->colorBufferView->Release();
-    context->dxColorBuffer->Release();
+bool DXGISwapChainAdapterHasPresentThread(DXGISwapChainAdapter* context) {
+    return context->present_queue != NULL;
+}
+
+static PresentQueueTimings read_present_thread_timings(DXGISwapChainAdapter* context) {
+    PresentQueueTimings timings;
+    PresentQueueReadTimings(context->present_queue, &timings);
+    return timings;
 }
 
 int64_t DXGISwapChainAdapterGetPresentTimestamp(DXGISwapChainAdapter* context) {
-    if(context->is_actually_vsynced) { //if not vsynced, we want to just use the measured time instead of the present time
+    if(context->present_queue) return read_present_thread_timings(context).present_timestamp;
+    if(context->vsync_estimator.is_vsynced) { //if not vsynced, we want to just use the measured time instead of the present time
         return context->frame_stats.SyncQPCTime.QuadPart;
     } else {
         return context->swap_timestamp;
     }
 }
 bool DXGISwapChainAdapterIsActuallyVsynced(DXGISwapChainAdapter* context) {
-    return context->is_actually_vsynced;
+    if(context->present_queue) return read_present_thread_timings(context).vsynced;
+    return context->vsync_estimator.is_vsynced;
+}
+void DXGISwapChainAdapterSetVsyncEstimatorConfig(DXGISwapChainAdapter* context, const VsyncEstimatorConfig* config) {
+    wait_for_present_thread(context);
+    VsyncEstimatorSetConfig(&context->vsync_estimator, config);
+}
+void DXGISwapChainAdapterResetVsyncDetection(DXGISwapChainAdapter* context, bool assume_vsynced) {
+    wait_for_present_thread(context);
+    VsyncEstimatorReset(&context->vsync_estimator, assume_vsynced);
+    context->vsync_detection_grace = 2; //the frame in flight + the one being prepared
+
+    //the getters read the snapshot, which still holds the decision from before the reset until the next present
+    if(context->present_queue) {
+        PresentQueueTimings timings = read_present_thread_timings(context);
+        timings.vsynced = context->vsync_estimator.is_vsynced;
+        PresentQueuePublishTimings(context->present_queue, &timings);
+    }
+}
+void DXGISwapChainAdapterSetRefreshRate(DXGISwapChainAdapter* context, int64_t numerator, int64_t denominator) {
+    wait_for_present_thread(context);
+    context->refresh_rate_rational.Numerator = (UINT)numerator;
+    context->refresh_rate_rational.Denominator = (UINT)denominator;
+    context->refresh_rate = (double)numerator / denominator;
 }
 
 int64_t DXGISwapChainAdapterGetTimingMethodDelta(DXGISwapChainAdapter* context) {
+    if(context->present_queue) return read_present_thread_timings(context).timing_method_delta;
     return context->swap_timestamp - context->frame_stats.SyncQPCTime.QuadPart;
 }
 
+Uint64 DXGISwapChainAdapterGetMissedPresents(DXGISwapChainAdapter* context) {
+    if(context->present_queue) return read_present_thread_timings(context).missed_presents;
+    return context->missed_presents;
+}
+
+int64_t DXGISwapChainAdapterGetSwapWaitTime(DXGISwapChainAdapter* context) {
+    if(context->present_queue) return context->submit_block_time; //the present thread blocking doesnt stall us, only a full queue does
+    return context->present_block_time + context->wait_block_time;
+}
+
 FrameStatistics DXGISwapChainAdapterGetFrameStatistics(DXGISwapChainAdapter* context) {
     FrameStatistics res;
+    if(context->present_queue) {
+        PresentQueueTimings timings = read_present_thread_timings(context);
+        res.sync_time = timings.sync_time;
+        res.present_count = timings.present_count;
+        res.present_refresh_count = timings.present_refresh_count;
+        res.sync_refresh_count = timings.sync_refresh_count;
+        return res;
+    }
     res.sync_time = context->frame_stats.SyncQPCTime.QuadPart;
     res.present_count = context->frame_stats.PresentCount;
     res.present_refresh_count = context->frame_stats.PresentRefreshCount;
@@ -1,6 +1,19 @@
+#pragma once
 #include <SDL3/SDL.h>
 
 struct DXGISwapChainAdapter;
+struct VsyncEstimatorConfig;
+enum DXGISwapChainAdapterLatencyMode {
+    DXGI_SWAPCHAIN_LATENCY_LOW,         //2 buffers, 1 frame queued
+    DXGI_SWAPCHAIN_LATENCY_BALANCED,    //3 buffers, 1 frame queued, the spare buffer absorbs present spikes without adding latency
+    DXGI_SWAPCHAIN_LATENCY_THROUGHPUT,  //3 buffers, 2 frames queued, the cpu can run a frame ahead
+};
+
+struct DXGISwapChainAdapterLatencyParams {
+    unsigned int buffer_count;
+    unsigned int max_frame_latency;
+};
+
 struct FrameStatistics {
     int64_t sync_time;
     unsigned int present_count;
@@ -8,14 +21,38 @@ struct FrameStatistics {
     unsigned int sync_refresh_count;
 };
 
-DXGISwapChainAdapter* CreateDXGISwapChainAdapter(SDL_Window* window);
-void DXGISwapChainAdapterResize(DXGISwapChainAdapter* context, int width, int height);
+DXGISwapChainAdapter* CreateDXGISwapChainAdapter(SDL_Window* window, DXGISwapChainAdapterLatencyMode latency_mode = DXGI_SWAPCHAIN_LATENCY_LOW);
+void DXGISwapChainAdapterSetLatencyMode(DXGISwapChainAdapter* context, DXGISwapChainAdapterLatencyMode latency_mode); //call between frames
+DXGISwapChainAdapterLatencyParams DXGISwapChainAdapterGetLatencyParams(DXGISwapChainAdapterLatencyMode latency_mode);
+int DXGISwapChainAdapterGetFrameLatency(DXGISwapChainAdapter* context); //frames that can be queued ahead of the display
+void DXGISwapChainAdapterResize(DXGISwapChainAdapter* context, int width, int height); //deferred, the rebuild happens once at the start of the next PrepareBuffers
+void DXGISwapChainAdapterSetResizeGranularity(DXGISwapChainAdapter* context, int granularity); //over-allocate the GL targets to multiples of this so small resizes dont reallocate, 0 = exact
 void DXGISwapChainAdapterPrepareBuffers(DXGISwapChainAdapter* context);
+
+//extra GL render targets shared with D3D (hud layers, post buffers...), locked together with the frame buffers so they dont add sync points
+//returns the GL texture name, or 0 if there is no room left. they keep their size across swapchain resizes
+//between PrepareBuffers and SwapBuffers the lock list cant change: a target registered then is first locked (usable) by the next PrepareBuffers,
+//and one unregistered then stays locked until SwapBuffers and is freed by the next PrepareBuffers
+unsigned int DXGISwapChainAdapterRegisterSharedTarget(DXGISwapChainAdapter* context, int width, int height);
+bool DXGISwapChainAdapterUnregisterSharedTarget(DXGISwapChainAdapter* context, unsigned int name); //false if name isnt a registered target
 void DXGISwapChainAdapterSwapBuffers(DXGISwapChainAdapter* context, int sync_interval);
+
+//present from a dedicated thread (see PresentQueue.h), SwapBuffers then only unlocks the GL side and queues the frame
+//the timing getters below keep working, they read what the present thread published last. call between frames
+void DXGISwapChainAdapterSetPresentThread(DXGISwapChainAdapter* context, bool enabled);
+bool DXGISwapChainAdapterHasPresentThread(DXGISwapChainAdapter* context);
+
 double DXGISwapChainAdapterRefreshRate(DXGISwapChainAdapter* context);
+void DXGISwapChainAdapterRefreshRateRational(DXGISwapChainAdapter* context, int64_t* numerator, int64_t* denominator); //exact, 59.94hz is 60000/1001
+bool DXGISwapChainAdapterUpdateRefreshRate(DXGISwapChainAdapter* context); //requeries the output the window is on, returns true if the rate changed
 int64_t DXGISwapChainAdapterGetPresentTimestamp(DXGISwapChainAdapter* context);
 bool DXGISwapChainAdapterIsActuallyVsynced(DXGISwapChainAdapter* context);
+void DXGISwapChainAdapterSetVsyncEstimatorConfig(DXGISwapChainAdapter* context, const VsyncEstimatorConfig* config);
+void DXGISwapChainAdapterResetVsyncDetection(DXGISwapChainAdapter* context, bool assume_vsynced); //drops detection history, use when the sync interval changes
+void DXGISwapChainAdapterSetRefreshRate(DXGISwapChainAdapter* context, int64_t numerator, int64_t denominator);
 
 FrameStatistics DXGISwapChainAdapterGetFrameStatistics(DXGISwapChainAdapter* context);
 
 int64_t DXGISwapChainAdapterGetTimingMethodDelta(DXGISwapChainAdapter* context);
+int64_t DXGISwapChainAdapterGetSwapWaitTime(DXGISwapChainAdapter* context); //time blocked in the last Present + the following latency wait
+Uint64 DXGISwapChainAdapterGetMissedPresents(DXGISwapChainAdapter* context); //total vblanks where a new frame was due but the old one stayed up, vsync only
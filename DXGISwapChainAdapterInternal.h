@@ -0,0 +1,15 @@
+#pragma once
+#include "DXGISwapChainAdapter.h"
+#include "Windows.h"
+
+//pieces of the DXGI adapter that only need a couple of swapchain calls, split out so tests can drive them with a mock instead of a device
+
+//the swapchain calls switching latency modes makes, user_data is what they act on (the adapter passes itself)
+struct DXGISwapChainLatencyOps {
+    HRESULT(*resize_buffers)(void* user_data, unsigned int buffer_count); //keeps the current size, every backbuffer reference must be released
+    HRESULT(*set_maximum_frame_latency)(void* user_data, unsigned int max_frame_latency);
+    void* user_data;
+};
+
+//moves a swapchain from current to params, each call is only made for the value that changed. stops at the first failure
+HRESULT DXGISwapChainAdapterApplyLatencyParams(const DXGISwapChainLatencyOps* ops, const DXGISwapChainAdapterLatencyParams* current, const DXGISwapChainAdapterLatencyParams* params);
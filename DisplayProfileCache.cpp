@@ -0,0 +1,127 @@
+#include "DisplayProfileCache.h"
+#include <cstdio>
+#include <cstring>
+
+static const Uint32 display_profile_magic = 0x50435046; //"FPCP"
+static const Uint32 display_profile_version = 2;
+static const int display_profile_max_entries = 16;
+
+//on-disk layout, every field naturally aligned so the struct has no padding
+struct DisplayProfileFileHeader {
+    Uint32 magic;
+    Uint32 version;
+    Uint32 count;
+    Uint32 reserved;
+};
+
+struct DisplayProfileFileEntry {
+    Uint64 key;
+    Uint64 generation; //higher is more recent, used for eviction
+    double refresh_period;
+    double present_latency;
+    Sint32 swap_interval;
+    Uint8 vsynced;
+    Uint8 reserved[3];
+};
+
+struct DisplayProfileCacheInternal {
+    DisplayProfileFileEntry entries[display_profile_max_entries];
+    int count;
+    Uint64 generation;
+} display_profile_cache;
+
+//FNV-1a, only has to be stable across runs, not cryptographic
+static Uint64 hash_bytes(Uint64 hash, const void* data, size_t size) {
+    const Uint8* bytes = (const Uint8*)data;
+    for(size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+Uint64 DisplayProfileCacheKey(const char* display_name, int width, int height, float refresh_rate, float pixel_density) {
+    Uint64 hash = 0xcbf29ce484222325ull;
+    if(display_name) hash = hash_bytes(hash, display_name, strlen(display_name));
+
+    //hash the mode as integers, so float formatting / rounding doesnt produce a new key every run
+    Sint32 mode[4] = { width, height, (Sint32)(refresh_rate * 1000 + .5f), (Sint32)(pixel_density * 100 + .5f) };
+    return hash_bytes(hash, mode, sizeof(mode));
+}
+
+bool DisplayProfileCacheLoad(const char* path) {
+    memset(&display_profile_cache, 0, sizeof(display_profile_cache));
+
+    FILE* file = fopen(path, "rb");
+    if(!file) return false;
+
+    DisplayProfileFileHeader header;
+    bool ok = fread(&header, sizeof(header), 1, file) == 1;
+    ok = ok && header.magic == display_profile_magic && header.version == display_profile_version && header.count <= (Uint32)display_profile_max_entries;
+    ok = ok && fread(display_profile_cache.entries, sizeof(DisplayProfileFileEntry), header.count, file) == header.count;
+    fclose(file);
+
+    if(!ok) {
+        memset(&display_profile_cache, 0, sizeof(display_profile_cache));
+        return false;
+    }
+
+    display_profile_cache.count = header.count;
+    for(int i = 0; i < display_profile_cache.count; i++) {
+        if(display_profile_cache.entries[i].generation > display_profile_cache.generation) display_profile_cache.generation = display_profile_cache.entries[i].generation;
+    }
+    return true;
+}
+
+bool DisplayProfileCacheSave(const char* path) {
+    FILE* file = fopen(path, "wb");
+    if(!file) return false;
+
+    DisplayProfileFileHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = display_profile_magic;
+    header.version = display_profile_version;
+    header.count = display_profile_cache.count;
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    ok = ok && fwrite(display_profile_cache.entries, sizeof(DisplayProfileFileEntry), header.count, file) == header.count;
+    return fclose(file) == 0 && ok;
+}
+
+bool DisplayProfileCacheFind(Uint64 key, DisplayTimingProfile* profile) {
+    for(int i = 0; i < display_profile_cache.count; i++) {
+        const DisplayProfileFileEntry* entry = &display_profile_cache.entries[i];
+        if(entry->key != key) continue;
+
+        profile->refresh_period = entry->refresh_period;
+        profile->present_latency = entry->present_latency;
+        profile->swap_interval = entry->swap_interval;
+        profile->vsynced = entry->vsynced != 0;
+        return true;
+    }
+    return false;
+}
+
+void DisplayProfileCacheStore(Uint64 key, const DisplayTimingProfile* profile) {
+    DisplayProfileFileEntry* entry = NULL;
+    for(int i = 0; i < display_profile_cache.count && !entry; i++) {
+        if(display_profile_cache.entries[i].key == key) entry = &display_profile_cache.entries[i];
+    }
+    if(!entry && display_profile_cache.count < display_profile_max_entries) {
+        entry = &display_profile_cache.entries[display_profile_cache.count++];
+    }
+    if(!entry) {
+        entry = &display_profile_cache.entries[0];
+        for(int i = 1; i < display_profile_cache.count; i++) {
+            if(display_profile_cache.entries[i].generation < entry->generation) entry = &display_profile_cache.entries[i];
+        }
+    }
+
+    memset(entry, 0, sizeof(DisplayProfileFileEntry));
+    entry->key = key;
+    entry->generation = ++display_profile_cache.generation;
+    entry->refresh_period = profile->refresh_period;
+    entry->present_latency = profile->present_latency;
+    entry->swap_interval = profile->swap_interval;
+    entry->vsynced = profile->vsynced?1:0;
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <SDL3/SDL.h>
+
+//small on-disk cache of what the pacer learned about each display, so a restart doesnt have to re-learn it
+//entries are keyed by display name + mode, a different monitor or a mode switch gets its own entry
+//the file is a fixed little-endian binary layout with a version number, a file with another version is ignored (and overwritten on save)
+//version 1 had no swap_interval, version 2 adds it
+
+struct DisplayTimingProfile {
+    double refresh_period; //seconds, measured between vblanks (can differ from what the mode reports, 59.94 vs 60)
+    double present_latency; //seconds, typical time a frame spent blocked in swap / present
+    int swap_interval; //what the app asked for while vsynced was decided, the decision only carries over to the same interval
+    bool vsynced; //what the vsync detector settled on last time
+};
+
+Uint64 DisplayProfileCacheKey(const char* display_name, int width, int height, float refresh_rate, float pixel_density);
+
+bool DisplayProfileCacheLoad(const char* path); //replaces whatever is in memory, false if there was no usable file
+bool DisplayProfileCacheSave(const char* path);
+
+bool DisplayProfileCacheFind(Uint64 key, DisplayTimingProfile* profile);
+void DisplayProfileCacheStore(Uint64 key, const DisplayTimingProfile* profile); //when full, the least recently stored entry is replaced
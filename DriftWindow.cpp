@@ -0,0 +1,299 @@
+#include "DriftWindow.h"
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#define DRIFT_WINDOW_AVX2
+#if defined(__GNUC__) || defined(__clang__)
+#define DRIFT_WINDOW_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define DRIFT_WINDOW_TARGET_AVX2 //msvc lets any function use the intrinsics, we only call it after checking the cpu
+#endif
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define DRIFT_WINDOW_NEON //always there on 64 bit arm
+#endif
+
+//sums over one contiguous run of errors, k counts from 0 at the start of the run
+struct DriftWindowSums {
+    double sum;
+    double squares;
+    double moment1; //sum of error * k
+    double moment2; //sum of error * k^2
+    int outliers;
+};
+
+typedef void(*DriftWindowKernel)(const int32_t* errors, int count, double threshold, DriftWindowSums* sums);
+
+static void kernel_scalar(const int32_t* errors, int count, double threshold, DriftWindowSums* sums) {
+    double sum = 0, squares = 0, moment1 = 0, moment2 = 0;
+    int outliers = 0;
+    for(int i = 0; i < count; i++) {
+        double error = errors[i];
+        double k = i;
+        sum += error;
+        squares += error * error;
+        moment1 += error * k;
+        moment2 += error * k * k;
+        outliers += fabs(error) > threshold;
+    }
+    sums->sum = sum;
+    sums->squares = squares;
+    sums->moment1 = moment1;
+    sums->moment2 = moment2;
+    sums->outliers = outliers;
+}
+
+//the vector kernels handle whatever doesnt fill a whole vector with the scalar one, shifted to where they stopped
+static void add_tail(const int32_t* errors, int start, int count, double threshold, DriftWindowSums* sums) {
+    DriftWindowSums tail;
+    kernel_scalar(errors + start, count - start, threshold, &tail);
+    double k = start;
+    sums->sum += tail.sum;
+    sums->squares += tail.squares;
+    sums->moment1 += k * tail.sum + tail.moment1;
+    sums->moment2 += k * k * tail.sum + 2 * k * tail.moment1 + tail.moment2;
+    sums->outliers += tail.outliers;
+}
+
+//errors are whole clocks, so comparing against the threshold rounded down gives the same count
+static int32_t integer_threshold(double threshold) {
+    if(threshold >= INT32_MAX) return INT32_MAX;
+    if(threshold < -1) return -1;
+    return (int32_t)floor(threshold);
+}
+
+#ifdef DRIFT_WINDOW_AVX2
+DRIFT_WINDOW_TARGET_AVX2 static void kernel_avx2(const int32_t* errors, int count, double threshold, DriftWindowSums* sums) {
+    __m256d sum = _mm256_setzero_pd();
+    __m256d squares = _mm256_setzero_pd();
+    __m256d moment1 = _mm256_setzero_pd();
+    __m256d moment2 = _mm256_setzero_pd();
+    __m256i outliers = _mm256_setzero_si256();
+    __m256d k = _mm256_set_pd(3, 2, 1, 0);
+    const __m256d step = _mm256_set1_pd(4);
+    const __m256i limit = _mm256_set1_epi32(integer_threshold(threshold)); //errors are whole clocks
+
+    int i = 0;
+    for(; i + 8 <= count; i += 8) {
+        //outliers on all 8 ints at once, the compare gives -1 per lane so subtracting it counts up
+        __m256i raw = _mm256_loadu_si256((const __m256i*)(errors + i));
+        outliers = _mm256_sub_epi32(outliers, _mm256_cmpgt_epi32(_mm256_abs_epi32(raw), limit));
+
+        //converting to double is exact, the rest is done 4 at a time
+        __m256d low = _mm256_cvtepi32_pd(_mm256_castsi256_si128(raw));
+        __m256d high = _mm256_cvtepi32_pd(_mm256_extracti128_si256(raw, 1));
+        __m256d k_high = _mm256_add_pd(k, step);
+        __m256d low_k = _mm256_mul_pd(low, k);
+        __m256d high_k = _mm256_mul_pd(high, k_high);
+        sum = _mm256_add_pd(sum, _mm256_add_pd(low, high));
+        squares = _mm256_add_pd(squares, _mm256_add_pd(_mm256_mul_pd(low, low), _mm256_mul_pd(high, high)));
+        moment1 = _mm256_add_pd(moment1, _mm256_add_pd(low_k, high_k));
+        moment2 = _mm256_add_pd(moment2, _mm256_add_pd(_mm256_mul_pd(low_k, k), _mm256_mul_pd(high_k, k_high)));
+        k = _mm256_add_pd(k_high, step);
+    }
+
+    double lanes[4];
+    _mm256_storeu_pd(lanes, sum); sums->sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    _mm256_storeu_pd(lanes, squares); sums->squares = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    _mm256_storeu_pd(lanes, moment1); sums->moment1 = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    _mm256_storeu_pd(lanes, moment2); sums->moment2 = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    int32_t counts[8];
+    _mm256_storeu_si256((__m256i*)counts, outliers);
+    sums->outliers = counts[0] + counts[1] + counts[2] + counts[3] + counts[4] + counts[5] + counts[6] + counts[7];
+
+    if(i < count) add_tail(errors, i, count, threshold, sums);
+}
+#endif
+
+#ifdef DRIFT_WINDOW_NEON
+static void kernel_neon(const int32_t* errors, int count, double threshold, DriftWindowSums* sums) {
+    float64x2_t sum = vdupq_n_f64(0);
+    float64x2_t squares = vdupq_n_f64(0);
+    float64x2_t moment1 = vdupq_n_f64(0);
+    float64x2_t moment2 = vdupq_n_f64(0);
+    uint32x4_t outliers = vdupq_n_u32(0);
+    const double start[2] = { 0, 1 };
+    float64x2_t k = vld1q_f64(start);
+    const float64x2_t step = vdupq_n_f64(2);
+    const int32x4_t limit = vdupq_n_s32(integer_threshold(threshold));
+
+    int i = 0;
+    for(; i + 4 <= count; i += 4) {
+        int32x4_t raw = vld1q_s32(errors + i);
+        outliers = vsubq_u32(outliers, vcgtq_s32(vqabsq_s32(raw), limit)); //all ones per lane, so subtracting counts up
+
+        float64x2_t low = vcvtq_f64_s64(vmovl_s32(vget_low_s32(raw)));
+        float64x2_t high = vcvtq_f64_s64(vmovl_s32(vget_high_s32(raw)));
+        float64x2_t k_high = vaddq_f64(k, step);
+        float64x2_t low_k = vmulq_f64(low, k);
+        float64x2_t high_k = vmulq_f64(high, k_high);
+        sum = vaddq_f64(sum, vaddq_f64(low, high));
+        squares = vfmaq_f64(vfmaq_f64(squares, low, low), high, high);
+        moment1 = vaddq_f64(moment1, vaddq_f64(low_k, high_k));
+        moment2 = vfmaq_f64(vfmaq_f64(moment2, low_k, k), high_k, k_high);
+        k = vaddq_f64(k_high, step);
+    }
+
+    sums->sum = vaddvq_f64(sum);
+    sums->squares = vaddvq_f64(squares);
+    sums->moment1 = vaddvq_f64(moment1);
+    sums->moment2 = vaddvq_f64(moment2);
+    sums->outliers = (int)vaddvq_u32(outliers);
+
+    if(i < count) add_tail(errors, i, count, threshold, sums);
+}
+#endif
+
+static DriftWindowKernel pick_kernel() {
+#ifdef DRIFT_WINDOW_AVX2
+    if(SDL_HasAVX2()) return kernel_avx2;
+#endif
+#ifdef DRIFT_WINDOW_NEON
+    return kernel_neon;
+#endif
+    return kernel_scalar;
+}
+
+static DriftWindowKernel kernel = pick_kernel();
+
+static int block_end(const DriftWindow* window, int block) {
+    int end = (block + 1) * window->block_length;
+    return end < window->length?end:window->length;
+}
+
+static void sum_block(DriftWindow* window, int block) {
+    int start = block * window->block_length;
+    DriftWindowSums sums;
+    kernel(window->errors + start, block_end(window, block) - start, window->outlier_threshold, &sums);
+    window->block_sum[block] = sums.sum;
+    window->block_squares[block] = sums.squares;
+    window->block_moment1[block] = sums.moment1;
+    window->block_moment2[block] = sums.moment2;
+    window->block_outliers[block] = sums.outliers;
+}
+
+void DriftWindowInit(DriftWindow* window, int length, int drift_length) {
+    if(length < 1) length = 1;
+    if(length > window->max_length) length = window->max_length;
+    if(drift_length < 1) drift_length = 1;
+    if(drift_length > length) drift_length = length;
+    window->length = length;
+    window->drift_length = drift_length;
+    window->outlier_threshold = 0;
+    DriftWindowReset(window);
+}
+
+void DriftWindowReset(DriftWindow* window) {
+    //errors and block sums past count are never read, no need to clear them
+    window->index = 0;
+    window->count = 0;
+    window->drift = 0;
+}
+
+void DriftWindowPush(DriftWindow* window, int64_t error) {
+    if(error > INT32_MAX) error = INT32_MAX;
+    if(error < -INT32_MAX) error = -INT32_MAX; //so the vector kernels can take the absolute value
+
+    int i = window->index;
+    if(window->count >= window->drift_length) { //read before the write, with drift_length == length its the same slot
+        window->drift -= window->errors[(i - window->drift_length + window->length) % window->length];
+    }
+    if(window->count < window->length) window->count++;
+    window->errors[i] = (int32_t)error;
+    window->drift += error;
+    window->index = (i + 1) % window->length;
+
+    int block = i / window->block_length;
+    if(i + 1 == block_end(window, block)) sum_block(window, block);
+}
+
+static void add_sums(const DriftWindowSums* sums, double position, DriftWindowSums* totals) {
+    //moving the moments from the start of the run to its window position
+    double p = position;
+    totals->sum += sums->sum;
+    totals->squares += sums->squares;
+    totals->moment1 += p * sums->sum + sums->moment1;
+    totals->moment2 += p * p * sums->sum + 2 * p * sums->moment1 + sums->moment2;
+    totals->outliers += sums->outliers;
+}
+
+//adds ring slots [start, end) to the totals, they sit at window position (0 = oldest) onwards
+//whole blocks come from their cached sums, only the ends of the range can be part of a block. those are shorter than a block,
+//too short for the vector kernels to win back their setup, so they are summed directly
+static void add_range(DriftWindow* window, int start, int end, double position, DriftWindowSums* totals) {
+    const int block_length = window->block_length;
+    int first_block = (start + block_length - 1) / block_length;
+    int last_block = first_block;
+    while(last_block * block_length < end && block_end(window, last_block) <= end) last_block++;
+
+    DriftWindowSums sums;
+    int head_end = first_block * block_length < end?first_block * block_length:end;
+    if(start < head_end) {
+        kernel_scalar(window->errors + start, head_end - start, window->outlier_threshold, &sums);
+        add_sums(&sums, position, totals);
+        position += head_end - start;
+    }
+
+    //the whole blocks, kept branch free since this is the bulk of a long window
+    double sum = 0, squares = 0, moment1 = 0, moment2 = 0;
+    int outliers = 0;
+    double p = position;
+    for(int block = first_block; block < last_block; block++, p += block_length) {
+        double block_sum = window->block_sum[block];
+        sum += block_sum;
+        squares += window->block_squares[block];
+        moment1 += p * block_sum + window->block_moment1[block];
+        moment2 += p * (p * block_sum + 2 * window->block_moment1[block]) + window->block_moment2[block];
+        outliers += window->block_outliers[block];
+    }
+    totals->sum += sum;
+    totals->squares += squares;
+    totals->moment1 += moment1;
+    totals->moment2 += moment2;
+    totals->outliers += outliers;
+
+    int tail_start = last_block * block_length;
+    if(tail_start < end && tail_start >= head_end) {
+        position += (double)tail_start - head_end;
+        kernel_scalar(window->errors + tail_start, end - tail_start, window->outlier_threshold, &sums);
+        add_sums(&sums, position, totals);
+    }
+}
+
+void DriftWindowComputeStats(DriftWindow* window, double outlier_threshold, DriftWindowStats* stats) {
+    memset(stats, 0, sizeof(DriftWindowStats));
+    int n = window->count;
+    stats->count = n;
+    if(n == 0) return;
+
+    if(outlier_threshold != window->outlier_threshold) {
+        window->outlier_threshold = outlier_threshold;
+        int written = n == window->length?window->length:window->index;
+        for(int block = 0; block * window->block_length < written; block++) {
+            if(block_end(window, block) <= written) sum_block(window, block);
+        }
+    }
+
+    //until the ring wraps the oldest error is at 0, after that its the next slot to be written
+    DriftWindowSums totals;
+    memset(&totals, 0, sizeof(totals));
+    if(n == window->length && window->index > 0) {
+        add_range(window, window->index, window->length, 0, &totals);
+        add_range(window, 0, window->index, window->length - window->index, &totals);
+    } else {
+        add_range(window, 0, n, 0, &totals);
+    }
+
+    stats->mean = totals.sum / n;
+    stats->variance = totals.squares / n - stats->mean * stats->mean;
+    if(stats->variance < 0) stats->variance = 0;
+    stats->outliers = totals.outliers;
+
+    //fitting a line through the accumulated drift D(i) = error[0] + ... + error[i] against i (centered on the window)
+    //sum(x_i * D(i)) folds into sum(error[j] * j * (n - j)) / 2 = (n * moment1 - moment2) / 2 and sum(x_i^2) is n(n^2 - 1) / 12
+    if(n > 1) stats->slope = 6 * ((double)n * totals.moment1 - totals.moment2) / ((double)n * ((double)n * n - 1));
+}
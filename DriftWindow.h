@@ -0,0 +1,41 @@
+#pragma once
+#include <SDL3/SDL.h>
+
+//history of per frame drift (measured swap delta minus the delta snapped to whole refreshes) for the non-DXGI vsync detector
+//the exact drift total over the most recent frames is kept up to date on every push. the other statistics come from per block sums: a block is summed once
+//by an AVX2 / NEON kernel (scalar when the cpu has neither) as soon as it fills up, so a frame only combines block sums
+//plus the one block the ring is part way through. that keeps even the longest window well under a microsecond
+
+struct DriftWindow {
+    static const int max_length = 8192;
+    static const int block_length = 64;
+    static const int max_blocks = max_length / block_length;
+    int length;
+    int index; //next slot to write
+    int count;
+    int drift_length; //the drift total only covers this many of the newest errors
+    int64_t drift; //sum of the newest drift_length errors
+
+    //sums over each finished block, moments are taken from the start of the block
+    double block_sum[max_blocks];
+    double block_squares[max_blocks];
+    double block_moment1[max_blocks]; //sum of error * k
+    double block_moment2[max_blocks]; //sum of error * k^2
+    int block_outliers[max_blocks];
+    double outlier_threshold; //what block_outliers was counted against
+
+    int32_t errors[max_length]; //clocks, oldest at index once the window is full
+};
+
+struct DriftWindowStats {
+    int count;
+    double mean; //clocks per frame
+    double variance; //clocks squared
+    double slope; //clocks per frame, least squares slope of the accumulated drift over the window
+    int outliers; //frames whose error was larger than the threshold
+};
+
+void DriftWindowInit(DriftWindow* window, int length, int drift_length); //length is clamped to 1..max_length, drift_length to 1..length
+void DriftWindowReset(DriftWindow* window);
+void DriftWindowPush(DriftWindow* window, int64_t error); //errors beyond 31 bits are clamped, they only ever come from frames seconds long
+void DriftWindowComputeStats(DriftWindow* window, double outlier_threshold, DriftWindowStats* stats); //a new threshold recounts every block once
@@ -0,0 +1,149 @@
+#include "FixedUpdatePool.h"
+#include "FrameTrace.h"
+#include <atomic>
+#include <thread>
+#include "Windows.h"
+
+//one per worker, on its own cache line since the owner and the thieves all hammer next
+struct alignas(64) FixedUpdateWorkerRange {
+    std::atomic<int> next;
+    int end;
+};
+
+struct FixedUpdatePool {
+    static const int max_threads = 64;
+    int thread_count;
+    std::thread threads[max_threads]; //[0] is unused, the thread calling FixedUpdatePoolRun is worker 0
+    FixedUpdateWorkerRange ranges[max_threads];
+    HANDLE wake; //released once per worker per run
+    bool stop;
+
+    //the current run, written before the workers are woken
+    int partition_count;
+    FixedUpdatePartitionCallback partition;
+    FixedUpdateSerialCallback serial;
+    FixedUpdateSerialCallback post_tick;
+    double delta_time;
+    void* user_data;
+    Uint64 run_start_tick;
+    Uint64 run_end_tick;
+
+    //barrier, tick only ever goes up (across runs too) so a worker still leaving the last run cant mistake the next one for its own
+    alignas(64) std::atomic<int> arrived;
+    alignas(64) std::atomic<Uint64> tick;
+};
+
+//contiguous ranges so each worker walks its own partitions in order, the remainder is spread over the first workers
+static void assign_ranges(FixedUpdatePool* pool) {
+    for(int w = 0; w < pool->thread_count; w++) {
+        pool->ranges[w].next.store((int)((int64_t)pool->partition_count * w / pool->thread_count), std::memory_order_relaxed);
+        pool->ranges[w].end = (int)((int64_t)pool->partition_count * (w+1) / pool->thread_count);
+    }
+}
+
+static void run_partitions(FixedUpdatePool* pool, int worker) {
+    //own range first, then steal one partition at a time from everyone else
+    //claiming past the end of a range is harmless, the counter just keeps going up until the next tick resets it
+    for(int v = 0; v < pool->thread_count; v++) {
+        FixedUpdateWorkerRange* range = &pool->ranges[(worker + v) % pool->thread_count];
+        int partition;
+        while((partition = range->next.fetch_add(1, std::memory_order_relaxed)) < range->end) {
+            pool->partition(partition, pool->delta_time, pool->user_data);
+        }
+    }
+}
+
+static void work(FixedUpdatePool* pool, int worker) {
+    Uint64 tick = pool->run_start_tick;
+    Uint64 end = pool->run_end_tick;
+
+    while(tick < end) {
+        {
+            FRAME_TRACE_ZONE("partitions");
+            run_partitions(pool, worker);
+        }
+
+        int arrived = pool->arrived.fetch_add(1, std::memory_order_acq_rel) + 1;
+        if(worker == 0) {
+            //the calling thread sets up every tick, so serial never lands on a worker (it may touch things only the caller owns)
+            //it waits for the rest here, then lets them go
+            while(arrived < pool->thread_count) {
+                std::this_thread::yield();
+                arrived = pool->arrived.load(std::memory_order_acquire);
+            }
+            pool->arrived.store(0, std::memory_order_relaxed);
+            if(pool->post_tick) pool->post_tick(pool->delta_time, pool->user_data);
+            if(tick + 1 < end) {
+                if(pool->serial) pool->serial(pool->delta_time, pool->user_data);
+                assign_ranges(pool);
+            }
+            pool->tick.store(tick + 1, std::memory_order_release);
+        } else {
+            //ticks are short and back to back, spinning here is what keeps catch-up ticks from paying for a wake-up each
+            while(pool->tick.load(std::memory_order_acquire) == tick) std::this_thread::yield();
+        }
+        tick++;
+    }
+}
+
+static void worker_thread(FixedUpdatePool* pool, int worker) {
+    while(true) {
+        WaitForSingleObject(pool->wake, INFINITE);
+        if(pool->stop) return;
+        work(pool, worker);
+    }
+}
+
+FixedUpdatePool* CreateFixedUpdatePool(int thread_count) {
+    if(thread_count <= 0) thread_count = SDL_GetNumLogicalCPUCores();
+    if(thread_count < 1) thread_count = 1;
+    if(thread_count > FixedUpdatePool::max_threads) thread_count = FixedUpdatePool::max_threads;
+
+    FixedUpdatePool* pool = new FixedUpdatePool();
+    pool->thread_count = thread_count;
+    pool->stop = false;
+    pool->arrived = 0;
+    pool->tick = 0;
+    pool->wake = CreateSemaphoreA(NULL, 0, thread_count, NULL);
+    for(int w = 1; w < thread_count; w++) {
+        pool->threads[w] = std::thread(worker_thread, pool, w);
+    }
+    return pool;
+}
+
+void DestroyFixedUpdatePool(FixedUpdatePool* pool) {
+    if(!pool) return;
+    pool->stop = true;
+    if(pool->thread_count > 1) ReleaseSemaphore(pool->wake, pool->thread_count - 1, NULL);
+    for(int w = 1; w < pool->thread_count; w++) {
+        pool->threads[w].join();
+    }
+    CloseHandle(pool->wake);
+    delete pool;
+}
+
+int FixedUpdatePoolThreadCount(FixedUpdatePool* pool) {
+    return pool->thread_count;
+}
+
+void FixedUpdatePoolRun(FixedUpdatePool* pool, int tick_count, int partition_count, FixedUpdatePartitionCallback partition,
+    FixedUpdateSerialCallback serial, FixedUpdateSerialCallback post_tick, double delta_time, void* user_data) {
+    if(tick_count <= 0) return;
+
+    pool->partition_count = partition_count;
+    pool->partition = partition;
+    pool->serial = serial;
+    pool->post_tick = post_tick;
+    pool->delta_time = delta_time;
+    pool->user_data = user_data;
+
+    Uint64 tick = pool->tick.load(std::memory_order_relaxed);
+    pool->run_start_tick = tick;
+    pool->run_end_tick = tick + tick_count;
+
+    if(serial) serial(delta_time, user_data);
+    assign_ranges(pool);
+
+    if(pool->thread_count > 1) ReleaseSemaphore(pool->wake, pool->thread_count - 1, NULL);
+    work(pool, 0);
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <SDL3/SDL.h>
+
+//persistent thread pool for running a fixed update split into partitions
+//every worker starts a tick on its own contiguous range of partitions and steals single partitions from the others once its range runs out,
+//so uneven partitions (dense crowds in one cell, empty ones elsewhere) still balance. ticks are separated by a barrier
+//workers are woken once per run, catch-up ticks in the same run go back to back through the barrier without sleeping in between
+
+typedef void(*FixedUpdatePartitionCallback)(int partition, double delta_time, void* user_data);
+typedef void(*FixedUpdateSerialCallback)(double delta_time, void* user_data);
+
+struct FixedUpdatePool;
+
+FixedUpdatePool* CreateFixedUpdatePool(int thread_count); //including the calling thread, <= 0 uses every logical core
+void DestroyFixedUpdatePool(FixedUpdatePool* pool);
+int FixedUpdatePoolThreadCount(FixedUpdatePool* pool);
+
+//runs tick_count ticks and returns when the last one is done, the calling thread works as one of the workers
+//serial (optional) runs alone at the start of every tick, before any of that ticks partitions, post_tick (optional) alone once all of
+//them finished, before the next ticks serial. both always run on the calling thread
+void FixedUpdatePoolRun(FixedUpdatePool* pool, int tick_count, int partition_count, FixedUpdatePartitionCallback partition,
+    FixedUpdateSerialCallback serial, FixedUpdateSerialCallback post_tick, double delta_time, void* user_data);
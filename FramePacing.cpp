@@ -1,9 +1,18 @@
 #include <SDL3/SDL.h>
+#ifndef FRAME_PACING_NO_SAMPLE //tests that drive the pacer (tests/FramePacingTest.cpp, FrameRecorderTest.cpp, GpuTimingTest.cpp, PresentQueueTest.cpp) include this file, with their own main
 #include <SDL3/SDL_main.h>
+#endif
 #include <SDL3/SDL_opengl.h>
 #include <cmath>
 #include <cstring>
 #include "DXGISwapChainAdapter.h"
+#include "DisplayProfileCache.h"
+#include "DriftWindow.h"
+#include "FrameRecorder.h"
+#include "FixedUpdatePool.h"
+#include "FrameTrace.h"
+#include "QuadBatch.h"
+#include "VsyncEstimator.h"
 #include <iostream>
 #include "Windows.h"
 
@@ -19,6 +28,11 @@ struct GameState {
 
     float view_w, view_h;
     bool yflip;
+    bool show_hud;
+    bool paused; //F4, freezes the scene so idle pacing kicks in
+
+    QuadBatch quads;
+    QuadBatchRenderer* quad_renderer;
 };
 
 void game_render(double delta_time, double frame_percent, void* data);
@@ -28,6 +42,13 @@ void game_variable_update(double delta_time, void* data);
 typedef void(*SDL_FramePacing_RenderCallback)(double,double,void*);
 typedef void(*SDL_FramePacing_FixedUpdateCallback)(double, void*);
 typedef void(*SDL_FramePacing_VariableUpdateCallback)(double, void*);
+typedef void(*SDL_FramePacing_PartitionUpdateCallback)(int, double, void*);
+
+//extended callbacks, get the whole per frame context instead of just the delta (see SDL_FramePacingContext below)
+struct SDL_FramePacingContext;
+typedef void(*SDL_FramePacing_RenderCallbackEx)(const SDL_FramePacingContext*, void*);
+typedef void(*SDL_FramePacing_FixedUpdateCallbackEx)(const SDL_FramePacingContext*, void*);
+typedef void(*SDL_FramePacing_VariableUpdateCallbackEx)(const SDL_FramePacingContext*, void*);
 
 struct SDL_FramePacingInfo {
     float update_rate;
@@ -35,31 +56,208 @@ struct SDL_FramePacingInfo {
     SDL_FramePacing_VariableUpdateCallback variable_update_callback;
     SDL_FramePacing_RenderCallback render_callback;
     void* user_data;
+
+    //parallel fixed update, off while partition_count is 0
+    //each tick runs fixed_update_callback alone first (optional here, for whatever cant be split), then partition_update_callback
+    //once for every partition spread over the worker threads. partitions of the same tick must not touch each others state
+    int partition_count;
+    SDL_FramePacing_PartitionUpdateCallback partition_update_callback;
+
+    //used instead of the plain callbacks above when set
+    SDL_FramePacing_FixedUpdateCallbackEx fixed_update_callback_ex;
+    SDL_FramePacing_VariableUpdateCallbackEx variable_update_callback_ex;
+    SDL_FramePacing_RenderCallbackEx render_callback_ex;
 };
 
 void SDL_PaceFrame(Uint64 delta_time, SDL_FramePacingInfo* pacing_info);
+void SDL_FramePacing_SetWorkerThreads(int thread_count); //threads the parallel fixed update uses, counting the main thread. 0 (default) uses every logical core
 Uint64 SDL_GetFrameTime();
+Uint64 SDL_GetPredictedDisplayTime(); //when the frame being built right now should hit the screen, in SDL_GetPerformanceCounter units
+
+//integer nanosecond timeline, for simulation code that wants exact time over long runs instead of summing doubles
+//conversions are a 32.32 fixed point multiply (no divide), per frame deltas carry their sub-nanosecond remainder into the next frame
+//so the timeline is always exactly the sum of the frame times, however long it runs
+Uint64 SDL_GetFrameTimeNS(); //SDL_GetFrameTime in nanoseconds
+Uint64 SDL_FramePacing_GetTimelineNS(); //sum of every reported frame time since init
+Uint64 SDL_FramePacing_ClocksToNS(Uint64 clocks);
+Uint64 SDL_FramePacing_NSToClocks(Uint64 ns);
+
+//hitch detection, frames that took much longer than expected get classified by whichever phase overran
+enum SDL_FramePacing_HitchClass {
+    SDL_FRAMEPACING_HITCH_SIM_OVERRUN,      //fixed + variable update took longer than the frame budget
+    SDL_FRAMEPACING_HITCH_RENDER_OVERRUN,   //render callback took longer than the frame budget
+    SDL_FRAMEPACING_HITCH_PRESENT_STALL,    //work fit in the budget, but swap / present blocked for more than a refresh
+    SDL_FRAMEPACING_HITCH_OS_SCHEDULING,    //none of the phases explain it, time went missing between them
+    SDL_FRAMEPACING_HITCH_CLASS_COUNT
+};
+
+struct SDL_FramePacingHitch {
+    SDL_FramePacing_HitchClass hitch_class;
+    double measured_time; //seconds, all of these describe the frame that hitched (the previous one)
+    double expected_time;
+    double sim_time;
+    double render_time;
+    double swap_time;
+    double gpu_time; //most recent gpu measurement, a few frames old (0 if gpu timing is off)
+};
+
+typedef void(*SDL_FramePacing_HitchCallback)(const SDL_FramePacingHitch*, void*);
+
+//everything the pacer already worked out for the current frame, filled in once per SDL_PaceFrame
+//the pointer is only valid during the callback, and the same struct is updated between fixed ticks
+struct SDL_FramePacingContext {
+    Uint64 frame_index;
+    Uint64 frame_timestamp; //SDL_GetPerformanceCounter units, the present / swap this frames delta was measured up to
+    Uint64 predicted_display_time; //SDL_GetPerformanceCounter units, same as SDL_GetPredictedDisplayTime
+    Uint64 clocks_per_second;
+    double delta_time; //seconds, what the variable update and render get
+    double fixed_delta_time; //seconds per fixed tick
+    Uint64 delta_time_ns;
+    Uint64 fixed_delta_time_ns; //rounded down, use simulated_time_ns for exact time
+    Uint64 timeline_ns; //SDL_FramePacing_GetTimelineNS
+    int tick_count; //fixed ticks run this frame
+    int tick_index; //which of them is running, in the fixed update. equals tick_count afterwards
+    Uint64 simulated_ticks; //fixed ticks since the start, including the one running
+    double simulated_time; //seconds, simulated_ticks * fixed_delta_time
+    Uint64 simulated_time_ns; //exact, fractional update rates included (to the millihertz)
+    double frame_percent; //accumulator left after this frames ticks, as a fraction of a tick (render interpolation)
+    double refresh_period; //seconds per display refresh
+    bool vsynced;
+    bool idle; //idle pacing is presenting every few refreshes
+    int generated_frames; //synthesized frames presented after this one (SDL_FramePacing_SetFrameGeneration)
+    Uint64 present_interval; //clocks between presents, generated frame i (from 1) is shown at predicted_display_time + i * present_interval
+    bool hitched; //the previous frame hitched, hitch_class says why
+    SDL_FramePacing_HitchClass hitch_class;
+    double gpu_time; //seconds, most recent gpu measurement (0 if gpu timing is off)
+    double load; //smoothed frame budget use, see SDL_FramePacing_GetHeadroom
+    double quality_adjustment; //SDL_FramePacingHeadroom adjustment, scale render cost by 1 + this
+};
+
+void SDL_FramePacing_SetHitchCallback(SDL_FramePacing_HitchCallback callback, void* user_data);
+void SDL_FramePacing_SetHitchThreshold(double threshold); //multiple of the expected frame time, default 1.5
+Uint64 SDL_FramePacing_GetHitchCount(SDL_FramePacing_HitchClass hitch_class);
+
+//gpu timing, the render callback is bracketed with timer queries that are read back a few frames later so nothing stalls
+//the default provider uses GL_TIME_ELAPSED queries, pass your own to time another api or to drive it with fake results
+struct SDL_FramePacingGpuQueryProvider {
+    void (*create_queries)(int count, unsigned int* queries, void* user_data);
+    void (*begin_query)(unsigned int query, void* user_data);
+    void (*end_query)(unsigned int query, void* user_data);
+    bool (*get_query_result)(unsigned int query, Uint64* nanoseconds, void* user_data); //must not block, false if the result isnt ready yet
+    void* user_data;
+};
+
+void SDL_FramePacing_EnableGpuTiming(const SDL_FramePacingGpuQueryProvider* provider); //NULL uses GL, needs the context to be current
+double SDL_GetGpuFrameTime(); //seconds, most recent completed measurement
+
+//frame timing overlay, queues rolling graphs of the last frames into batch (nothing is drawn until the batch is flushed)
+//lanes from the top: measured delta (grey) with the reported delta (green) and expected delta (yellow) on top,
+//accumulator fill after the fixed updates, vsync detector state (green synced / red not), fixed ticks run that frame
+void SDL_FramePacing_DrawHUD(QuadBatch* batch, float x, float y, float w, float h);
+
+//vsync detection tuning for the non-DXGI path (see DXGISwapChainAdapterSetVsyncEstimatorConfig for DXGI)
+void SDL_FramePacing_SetVsyncEstimatorConfig(const VsyncEstimatorConfig* config);
+
+//tell the pacer the app changed its swap interval, or that the window moved to a display with a different refresh rate
+//this flushes the vsync detection history and seeds it with the new mode, so pacing switches over in a frame or two instead of 16+
+void SDL_FramePacing_NotifySwapIntervalChanged(DXGISwapChainAdapter* swapchain, int swap_interval);
+void SDL_FramePacing_NotifyRefreshRateChanged(DXGISwapChainAdapter* swapchain, double refresh_rate);
+
+//stream every frame's raw timestamps and the pacer's decisions to a compact binary file (see FrameRecorder.h for the format and reader)
+bool SDL_FramePacing_StartRecording(const char* path);
+void SDL_FramePacing_StopRecording();
+
+//remember what was learned about the current display + mode across runs (see DisplayProfileCache.h)
+//load after creating the swapchain: seeds the measured refresh period and swap wait, and the last vsync state if it was saved under the same swap interval, so pacing is even from the first frames
+//save on shutdown with the swap interval the app is asking for (not an idle multiple), both keep the other displays' entries in the file
+bool SDL_FramePacing_LoadDisplayProfile(SDL_Window* window, DXGISwapChainAdapter* swapchain, int swap_interval, const char* path);
+bool SDL_FramePacing_SaveDisplayProfile(SDL_Window* window, DXGISwapChainAdapter* swapchain, int swap_interval, const char* path);
+
+//idle pacing, when nothing on screen changes and there is no input, present every few refreshes instead of every one
+//the app says a frame was unchanged with SDL_FramePacing_ReportStateUnchanged, any input event through SDL_FramePacing_HandleEvent goes back to full rate
+//snapping and the fixed update accumulator see the longer frames as whole refresh multiples, so game time stays exact through the switch
+void SDL_FramePacing_SetIdlePacing(int frames_before_idle, int idle_swap_interval); //0 frames disables, the interval is clamped to 2..4 (the most DXGI allows)
+void SDL_FramePacing_ReportStateUnchanged(); //call any time during a frame where nothing visible changed
+int SDL_FramePacing_GetSwapInterval(DXGISwapChainAdapter* swapchain, int swap_interval); //call right before swapping, returns the interval to actually swap with (sleeps instead when vsync is off)
+bool SDL_FramePacing_IsIdle();
+
+//frame generation, the app presents a few synthesized frames (reprojected / interpolated) after every real one
+//the pacer still runs once per real frame: deltas, fixed ticks and frame_percent are all at the real cadence, and the vsync snapping
+//expects each real frame to span 1 + generated_frames presents. call ComputeDeltaTime / SDL_PaceFrame for real frames only, but swap for all of them
+void SDL_FramePacing_SetFrameGeneration(int generated_frames); //0 turns it off, clamped to 0..3
+int SDL_FramePacing_GetGeneratedFrameCount();
+Uint64 SDL_FramePacing_GetGeneratedFrameDisplayTime(int index); //when generated frame index (from 1) of the current real frame will be shown, SDL_GetPerformanceCounter units
+
+//frame budget headroom, a feedback signal for dynamic resolution / quality
+//load is how much of the frame budget (the refreshes each real frame is expected to span) the last frame used, the larger of cpu sim + render and gpu time.
+//without vsync the typical time spent blocked in present counts too, with vsync that is just waiting for the vblank
+//a frame that missed a refresh always counts as over budget, by the refreshes it missed. the load is smoothed, then a PID controller turns its distance
+//from target_load into adjustment, a step to scale the render cost by this frame (-0.02 = make the next frame about 2% cheaper)
+//with hysteresis: adjustment stays 0 until the load leaves target_load +- dead_band, then keeps going until the load gets back to the target
+//so quality doesnt flip between two settings every few frames
+struct SDL_FramePacingHeadroomConfig {
+    double target_load; //fraction of the budget to settle at, the rest absorbs spikes
+    double dead_band;
+    double kp, ki, kd; //per frame, on target_load - load
+    double smoothing; //weight of each new frame in the smoothed load
+    double max_adjustment; //per frame step limit, either way
+};
+
+struct SDL_FramePacingHeadroom {
+    double load; //smoothed, 1 = the whole budget
+    double raw_load; //the last frame alone
+    double adjustment; //0 inside the dead band, negative = over budget, scale down
+    bool adjusting; //outside the dead band and not back at the target yet
+    int missed_refreshes; //refreshes the last frame missed, vsync only (DXGI frame statistics, or the snapped estimate without DXGI)
+    Uint64 total_missed_refreshes;
+};
+
+SDL_FramePacingHeadroomConfig SDL_FramePacing_DefaultHeadroomConfig();
+void SDL_FramePacing_SetHeadroomConfig(const SDL_FramePacingHeadroomConfig* config);
+SDL_FramePacingHeadroom SDL_FramePacing_GetHeadroom(); //as of the start of the current SDL_PaceFrame
+
+//feed every event through this, it tracks which display the window is on and requeries the refresh rate when that (or the display mode) changes
+//input events also count as activity for idle pacing
+void SDL_FramePacing_HandleEvent(SDL_Window* window, DXGISwapChainAdapter* swapchain, const SDL_Event* event);
+
+//where the pacer reads time from, SDL_GetPerformanceCounter by default. set before SDL_Internal_FramePacing_Init, NULL goes back to the default
+//with a scripted clock the non-DXGI path can be driven without a window: SDL_Internal_SwapBuffersAndMeasureTime_NonDXGI(NULL) takes its swap timestamps
+//from the clock (read once before and once after the swap), then ComputeDeltaTime(NULL) + SDL_PaceFrame as usual. idle pacing doesnt sleep on a scripted clock
+typedef Uint64(*SDL_FramePacing_ClockCallback)(void*);
+void SDL_FramePacing_SetClock(SDL_FramePacing_ClockCallback clock, Uint64 clocks_per_second, void* user_data);
 
 
 void SDL_Internal_FramePacing_ComputeDeltaTime(DXGISwapChainAdapter* swapchain);
 void SDL_Internal_FramePacing_Init(SDL_Window* window);
+void SDL_Internal_FramePacing_Shutdown();
 void SDL_Internal_SwapBuffersAndMeasureTime_NonDXGI(SDL_Window* window);
+void SDL_Internal_FramePacing_TraceMarkers(DXGISwapChainAdapter* swapchain);
 
+#ifndef FRAME_PACING_NO_SAMPLE
 int main(int argc, char* argv[]) {
     bool use_dxgi = true;
+    bool use_present_thread = false; //DXGI only, present from a separate thread so swap blocking doesnt hold up events and simulation
 
     SDL_Init(SDL_INIT_VIDEO | SDL_INIT_EVENTS);
+    FrameTraceInit(1 << 16); //press F12 to dump the last ~65k zones per thread to frame_trace.json
     SDL_Window* window = SDL_CreateWindow("Frame Pacing Sample (vsync on)", 1280, 720, SDL_WINDOW_OPENGL | SDL_WINDOW_RESIZABLE | SDL_WINDOW_HIGH_PIXEL_DENSITY);
     SDL_Internal_FramePacing_Init(window);
     SDL_GLContext glcontext = SDL_GL_CreateContext(window);
     if(!use_dxgi) SDL_GL_SetSwapInterval(1);
     DXGISwapChainAdapter* swapchain = use_dxgi?CreateDXGISwapChainAdapter(window):NULL;
+    if(swapchain && use_present_thread) DXGISwapChainAdapterSetPresentThread(swapchain, true);
+    SDL_FramePacing_EnableGpuTiming(NULL);
+    int swap_interval = 1;
+    SDL_FramePacing_LoadDisplayProfile(window, swapchain, swap_interval, "frame_pacing_profiles.bin");
+    SDL_FramePacing_SetIdlePacing(60, 4); //after a second without changes, drop to a quarter of the refresh rate
 
     bool running = true;
     bool vsync = true;
 
     GameState state = {0};
     state.yflip = use_dxgi;
+    QuadBatchInit(&state.quads, 4096);
+    state.quad_renderer = CreateQuadBatchRenderer(4096);
 
     SDL_FramePacingInfo pacing_info = {0};
     pacing_info.update_rate = 144;//DXGISwapChainAdapterRefreshRate(swapchain);//60;
@@ -69,15 +267,17 @@ int main(int argc, char* argv[]) {
     pacing_info.user_data = &state;
 
     while(running) {
+        FrameTraceBeginZone("poll events");
         SDL_Event event;
         while(SDL_PollEvent(&event)) {
+            SDL_FramePacing_HandleEvent(window, swapchain, &event);
             if(event.type == SDL_EVENT_WINDOW_CLOSE_REQUESTED) {
                 running = false;
             }
             if(event.type == SDL_EVENT_MOUSE_BUTTON_DOWN) { //click to toggle vsync
                 if(event.button.which == 0) {
                     vsync = !vsync;
-                    if(!use_dxgi) SDL_GL_SetSwapInterval(vsync);
+                    SDL_FramePacing_NotifySwapIntervalChanged(swapchain, vsync);
                     if(vsync) {
                         SDL_SetWindowTitle(window, "Frame Pacing Sample (vsync on)");
                     } else {
@@ -90,23 +290,69 @@ int main(int argc, char* argv[]) {
                 state.view_w = event.window.data1;
                 state.view_h = event.window.data2;
             }
+            if(event.type == SDL_EVENT_KEY_DOWN && event.key.keysym.scancode == SDL_SCANCODE_F3) {
+                state.show_hud = !state.show_hud;
+            }
+            if(event.type == SDL_EVENT_KEY_DOWN && event.key.keysym.scancode == SDL_SCANCODE_F4) {
+                state.paused = !state.paused;
+            }
+            if(event.type == SDL_EVENT_KEY_DOWN && event.key.keysym.scancode == SDL_SCANCODE_F10) {
+                if(FrameRecorderIsOpen()) {
+                    SDL_FramePacing_StopRecording();
+                } else {
+                    SDL_FramePacing_StartRecording("frame_record.bin");
+                }
+            }
+            if(event.type == SDL_EVENT_KEY_DOWN && event.key.keysym.scancode == SDL_SCANCODE_F12) {
+                FrameTraceWriteChromeJSON("frame_trace.json");
+            }
         };
+        FrameTraceEndZone();
 
-        if(use_dxgi) DXGISwapChainAdapterPrepareBuffers(swapchain);
+        if(use_dxgi) {
+            FRAME_TRACE_ZONE("prepare buffers");
+            DXGISwapChainAdapterPrepareBuffers(swapchain);
+        }
         SDL_Internal_FramePacing_ComputeDeltaTime(swapchain);
+        SDL_Internal_FramePacing_TraceMarkers(swapchain);
 
         Uint64 frame_time = SDL_GetFrameTime();
         SDL_PaceFrame(frame_time, &pacing_info);
 
+        FrameTraceBeginZone("swap");
+        int effective_swap_interval = SDL_FramePacing_GetSwapInterval(swapchain, vsync);
         if(use_dxgi) {
-            DXGISwapChainAdapterSwapBuffers(swapchain, vsync);
+            DXGISwapChainAdapterSwapBuffers(swapchain, effective_swap_interval);
         } else {
+            if(effective_swap_interval != swap_interval) SDL_GL_SetSwapInterval(effective_swap_interval);
             SDL_Internal_SwapBuffersAndMeasureTime_NonDXGI(window);
         }
+        swap_interval = effective_swap_interval;
+
+        //with frame generation on, the synthesized frames go out right after the real one (this sample has none, so its off)
+        //each is shown at SDL_FramePacing_GetGeneratedFrameDisplayTime(i), which is the time to reproject / interpolate it for
+        for(int i = 1; i <= SDL_FramePacing_GetGeneratedFrameCount(); i++) {
+            if(use_dxgi) {
+                DXGISwapChainAdapterPrepareBuffers(swapchain);
+                DXGISwapChainAdapterSwapBuffers(swapchain, effective_swap_interval);
+            } else {
+                SDL_Internal_SwapBuffersAndMeasureTime_NonDXGI(window);
+            }
+        }
+        FrameTraceEndZone();
     }
 
+    if(swapchain) DXGISwapChainAdapterSetPresentThread(swapchain, false);
+    SDL_FramePacing_StopRecording();
+    SDL_FramePacing_SaveDisplayProfile(window, swapchain, vsync?1:0, "frame_pacing_profiles.bin");
+    SDL_Internal_FramePacing_Shutdown();
+    DestroyQuadBatchRenderer(state.quad_renderer);
+    QuadBatchFree(&state.quads);
+    FrameTraceShutdown();
+
     return 0;
 }
+#endif
 
 //sample user code
 float lerp(float a, float b, float t) {
@@ -118,13 +364,9 @@ float clamp(float v, float min, float max) {
     return v;
 }
 
-void draw_gl_rect(float x, float y, float w, float h) {
-    glBegin(GL_QUADS);
-    glVertex2f(x, y);
-    glVertex2f(x+w, y);
-    glVertex2f(x+w, y+h);
-    glVertex2f(x, y+h);
-    glEnd();
+//rects are queued and drawn together at the end of game_render
+void draw_gl_rect(GameState* state, float x, float y, float w, float h, float r, float g, float b, float a) {
+    QuadBatchPush(&state->quads, x, y, w, h, QuadBatchColor(r, g, b, a));
 }
 
 void game_render(double delta_time, double frame_percent, void* data) {
@@ -139,41 +381,44 @@ void game_render(double delta_time, double frame_percent, void* data) {
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     //meter in the middle that shows frame percent
-    glColor4f(.5, .5, .5, .5);
-    draw_gl_rect(0, 0, 40, 720);
-
-    glColor4f(1, 1, 1, 1);
-    draw_gl_rect(0, 0, 40, 720*frame_percent);
+    draw_gl_rect(state, 0, 0, 40, 720, .5, .5, .5, .5);
+    draw_gl_rect(state, 0, 0, 40, 720*frame_percent, 1, 1, 1, 1);
 
     //pacer is updated in variable update, but doesnt respect delta time, draw its actual position
-    glColor4f(1, 0, 0, 1);
-    draw_gl_rect(
+    draw_gl_rect(state,
         state->pacer_x - 20,
         state->pacer_y - 20,
-        40, 40
+        40, 40,
+        1, 0, 0, 1
     );
 
     //red box is updated in variable update, draw its actual position
-    glColor4f(1,0,0,1);
-    draw_gl_rect(
+    draw_gl_rect(state,
         state->red_x - 20, 
         state->red_y - 20,
-        40, 40
+        40, 40,
+        1, 0, 0, 1
     );
 
     //blue box is updated in fixed update, draw its interpolated position
-    glColor4f(0, 0, 1, 1);
-    draw_gl_rect(
+    draw_gl_rect(state,
         lerp(state->blue_previous_x, state->blue_x, frame_percent) - 20, 
         lerp(state->blue_previous_y, state->blue_y, frame_percent) - 20,
-        40, 40
+        40, 40,
+        0, 0, 1, 1
     );
 
+    if(state->show_hud) SDL_FramePacing_DrawHUD(&state->quads, 60, 10, 512, 200); //F3
+
+    //everything above goes out in one draw
+    QuadBatchRendererFlush(state->quad_renderer, &state->quads);
+
     //uncomment this to simulate rendering taking longer (change the number)
     //SDL_Delay(7);
 }
 void game_fixed_update(double delta_time, void* data) {
     GameState* state = (GameState*)data;
+    if(state->paused) return;
 
     //cache blue box position, for interpolation
     state->blue_previous_x = state->blue_x;
@@ -199,6 +444,13 @@ void game_fixed_update(double delta_time, void* data) {
 void game_variable_update(double delta_time, void* data) {
     //move red box in a sin wave
     GameState* state = (GameState*)data;
+    if(state->paused) {
+        //the blue box was snapped to its last fixed update position, so it doesnt move while paused either
+        state->blue_previous_x = state->blue_x;
+        state->blue_previous_y = state->blue_y;
+        SDL_FramePacing_ReportStateUnchanged();
+        return;
+    }
     state->red_timer += delta_time * 10;
 
     state->red_y = 360;
@@ -214,51 +466,218 @@ void game_variable_update(double delta_time, void* data) {
 
 
 //sample frame timing internal
-struct FrameTimingInternal {
+//the state every frame reads and writes is split into cache line aligned blocks, so nothing touched per frame straddles a line shared
+//with a neighbour, and a thread reading one block (telemetry, the present thread, fixed update workers) never false shares with the frame
+//thread writing another. bulk history buffers are kept out of these blocks, each frame only touches one slot of them
+struct alignas(64) FrameTimingInternal {
     int64_t delta_time;
+    int64_t measured_delta_time; //raw delta before snapping / smoothing
+    int64_t expected_delta_time; //what we thought the frame would take before measuring it
+    int64_t swap_wait_time; //time the last frame spent blocked in swap / present
+    int64_t predicted_display_time;
     int64_t clocks_per_second;
     int64_t prev_frame_time;
     int64_t snap_error;
     int64_t non_vsync_smoother;
     int64_t non_vsync_error;
+    int64_t refresh_period_remainder; //carried between snaps so fractional refresh rates stay exact
+    int64_t refresh_period; //clocks per refresh of the current display
+    int64_t frame_timestamp; //present / swap time the last delta was measured up to
+    bool is_vsynced; //what the active timing backend decided for the last frame
+    int generated_frames; //synthesized presents after each real frame, 0 = frame generation off
+    int64_t present_interval; //clocks between presents, real or generated
+    int missed_refreshes; //by the last frame, vsync only
+    Uint64 dxgi_missed_presents; //running total the swapchain reported last frame
+
+    //long term averages, persisted per display (see SDL_FramePacing_SaveDisplayProfile)
+    double measured_refresh_period; //clocks between vblanks, 0 until we've seen vsynced frames
+    double typical_swap_wait; //clocks
 
     int64_t drift; //the difference between the sum of reported times, and the measured real times
+
+    //nanosecond timeline, the multipliers are 32.32 fixed point
+    Uint64 clocks_to_ns;
+    Uint64 ns_to_clocks;
+    Uint64 ns_carry; //fraction of a nanosecond left over from the last converted delta
+    Uint64 delta_time_ns;
+    Uint64 timeline_ns;
 } frame_timing_info;
 
-struct FrameTimingInternal_NonDXGI {
+struct alignas(64) FrameTimingInternal_NonDXGI {
     int64_t swap_time;
-    double window_refresh_rate;
-    bool is_actually_vsynced;
-
-    static const int drift_detection_window = 128;
-    int64_t snapped_deltas[drift_detection_window];
-    int64_t realtime_deltas[drift_detection_window];
-    int64_t drift_detection_index;
-    int64_t snapped_total;
-    int64_t realtime_total;
+    int64_t swap_duration;
+    int64_t refresh_numerator; //window refresh rate as an exact fraction, 59.94hz is 60000/1001
+    int64_t refresh_denominator;
     int64_t snap_error;
-    int is_vsynced_estimator;
+    int detection_grace; //swaps to skip detection for after a mode change, the one in flight still used the old mode
 
+    VsyncEstimator estimator; //last, its scalars come first and its residual history trails into the next lines
 } frame_timing_info_ndxgi;
 
-struct FramePacingInternal {
+struct alignas(64) FramePacingInternal {
     int64_t accumulator;
+    int worker_threads;
+    FixedUpdatePool* worker_pool; //created by the first frame that has partitions
+    SDL_FramePacingContext context;
+    Uint64 update_rate_millihertz;
+    SDL_FramePacingInfo* running_info; //for the serial step of a parallel fixed update, the pool only passes the apps user_data through
 } frame_pacing_info;
 
+//per frame history for the HUD, fixed size so recording never allocates
+struct alignas(64) FrameHistoryInternal {
+    static const int length = 256;
+    int64_t measured_delta[length];
+    int64_t reported_delta[length];
+    int64_t expected_delta[length];
+    float accumulator_fill[length];
+    bool vsynced[length];
+    int ticks[length];
+    int index; //next slot to write
+    int count;
+} frame_history_info;
+
+//realtime - snapped delta per frame for the non-DXGI vsync detection, tens of kilobytes so it stays out of frame_timing_info_ndxgi
+struct alignas(64) FrameDriftHistoryInternal {
+    DriftWindow window;
+} frame_drift_history_info;
+
+struct alignas(64) FrameIdleInternal {
+    int frames_before_idle; //0 = idle pacing off
+    int idle_swap_interval;
+    int unchanged_frames; //frames in a row with no input and no reported change
+    bool saw_input; //since the last swap
+    bool reported_unchanged; //since the last swap
+    bool is_idle;
+    int refresh_multiple; //refreshes each frame is expected to take at the current rate, 1 unless idle
+} frame_idle_info;
+
+struct alignas(64) FrameClockInternal {
+    SDL_FramePacing_ClockCallback callback; //NULL = SDL_GetPerformanceCounter
+    Uint64 clocks_per_second;
+    void* user_data;
+} frame_clock_info; //not reset by init, the clock has to be in place before it
+
+struct alignas(64) FrameRecordingInternal {
+    FrameRecord pending; //filled in by ComputeDeltaTime, finished and appended once PaceFrame knows the tick count
+    bool has_pending; //pending was filled in while recording, a recording started between the two waits for the next frame
+} frame_recording_info;
+
+struct alignas(64) FrameGpuTimingInternal {
+    bool enabled;
+    SDL_FramePacingGpuQueryProvider provider;
+
+    //queries are issued in order and read back in order, a few frames behind
+    static const int query_count = 4;
+    unsigned int queries[query_count];
+    Uint64 issued; //total queries issued
+    Uint64 resolved; //total queries read back
+
+    int64_t gpu_frame_time; //clock ticks, so it compares directly with the cpu side timings
+
+    static const int history_length = 128;
+    int64_t history[history_length];
+    int history_index;
+} frame_gpu_timing_info;
+
+struct alignas(64) FrameHeadroomInternal {
+    SDL_FramePacingHeadroomConfig config;
+    SDL_FramePacingHeadroom headroom;
+    int direction; //which side of the target the load was when adjusting started, 1 = under
+    double integral;
+    double prev_error;
+} frame_headroom_info;
+
+struct alignas(64) FrameHitchInternal {
+    //phase timings of the last SDL_PaceFrame, the hitch shows up in the delta measured at the start of the next one
+    int64_t sim_time;
+    int64_t render_time;
+    bool has_phase_timings;
+
+    double threshold;
+    Uint64 counts[SDL_FRAMEPACING_HITCH_CLASS_COUNT];
+    SDL_FramePacing_HitchCallback callback;
+    void* user_data;
+} frame_hitch_info;
+
+//SDL only gives us a float refresh rate, recover the exact rate for the common fractional (NTSC style) ones
+static void refresh_rate_to_rational(double refresh_rate, int64_t* numerator, int64_t* denominator) {
+    if(refresh_rate <= 0) { //unknown, assume 60hz like everyone else does
+        *numerator = 60;
+        *denominator = 1;
+        return;
+    }
+
+    double whole = round(refresh_rate);
+    double ntsc = round(refresh_rate * 1.001);
+    if(fabs(refresh_rate - whole) < .01) {
+        *numerator = (int64_t)whole;
+        *denominator = 1;
+    } else if(fabs(refresh_rate - ntsc / 1.001) < .01) { //59.94, 119.88, 143.86...
+        *numerator = (int64_t)ntsc * 1000;
+        *denominator = 1001;
+    } else {
+        *numerator = (int64_t)round(refresh_rate * 1000);
+        *denominator = 1000;
+    }
+}
+
+static void get_refresh_rate(DXGISwapChainAdapter* swapchain, int64_t* numerator, int64_t* denominator) {
+    if(swapchain) {
+        DXGISwapChainAdapterRefreshRateRational(swapchain, numerator, denominator);
+    } else {
+        *numerator = frame_timing_info_ndxgi.refresh_numerator;
+        *denominator = frame_timing_info_ndxgi.refresh_denominator;
+    }
+}
+
+//exact length of a number of refreshes in clock ticks, the remainder is carried so the reported times dont drift away from real time at fractional rates
+static int64_t refresh_periods_to_clocks(int count, int64_t numerator, int64_t denominator) {
+    int64_t total = frame_timing_info.clocks_per_second * denominator * count + frame_timing_info.refresh_period_remainder;
+    frame_timing_info.refresh_period_remainder = total % numerator;
+    return total / numerator;
+}
+
+//numerator / denominator as 32.32 fixed point, rounded. both are counter frequencies, so they fit in 32 bits
+static Uint64 fixed_point_ratio(Uint64 numerator, Uint64 denominator) {
+    return (numerator / denominator << 32) + (((numerator % denominator) << 32) + denominator / 2) / denominator;
+}
+
+//value * multiplier (32.32) split into 32 bit halves so nothing overflows before the result would
+//with carry the fraction is kept for the next call (so a series of deltas converts to exactly the converted sum), without it the result is rounded
+static Uint64 fixed_point_multiply(Uint64 value, Uint64 multiplier, Uint64* carry) {
+    Uint64 whole = multiplier >> 32;
+    Uint64 fraction = multiplier & 0xffffffff;
+    Uint64 low = (value & 0xffffffff) * fraction + (carry?*carry:0x80000000);
+    if(carry) *carry = low & 0xffffffff;
+    return value * whole + (value >> 32) * fraction + (low >> 32);
+}
+
+static Uint64 pacer_clock() {
+    if(frame_clock_info.callback) return frame_clock_info.callback(frame_clock_info.user_data);
+    return SDL_GetPerformanceCounter();
+}
+
+void SDL_FramePacing_SetClock(SDL_FramePacing_ClockCallback clock, Uint64 clocks_per_second, void* user_data) {
+    frame_clock_info.callback = clock;
+    frame_clock_info.clocks_per_second = clocks_per_second;
+    frame_clock_info.user_data = user_data;
+}
+
 void SDL_Internal_SwapBuffersAndMeasureTime_NonDXGI(SDL_Window* window) {
-    //commented out time and delta here was a futile attempt to "measure if SDL_GL_SwapWindow blocked", 
+    //measuring how long SDL_GL_SwapWindow took was a futile attempt to "detect if it blocked" for vsync detection,
     //unfortunately even when it doesnt block it can still take ~0.5ms which is too much error to be useful I think
-    //int64_t time = SDL_GetPerformanceCounter();
+    //it is still good enough for hitch attribution though, where we only care about stalls much longer than that
+    int64_t swap_start = pacer_clock();
     if(window) SDL_GL_SwapWindow(window);
-    //int64_t delta = SDL_GetPerformanceCounter() - time;
 
     //timestamp
-    int64_t timestamp = SDL_GetPerformanceCounter();
+    int64_t timestamp = pacer_clock();
+    frame_timing_info_ndxgi.swap_duration = timestamp - swap_start;
     int64_t delta = timestamp - frame_timing_info_ndxgi.swap_time;
     frame_timing_info_ndxgi.swap_time = timestamp;
 
     //VSYNC DETECTION (this is the part that is especially annoying without DXGI)
-    int64_t monitor_refresh_period = frame_timing_info.clocks_per_second / frame_timing_info_ndxgi.window_refresh_rate;
+    int64_t monitor_refresh_period = frame_timing_info.clocks_per_second * frame_timing_info_ndxgi.refresh_denominator / frame_timing_info_ndxgi.refresh_numerator;
 
     //this is essentially copied from how we do snapping in SDL_Internal_FramePacing_ComputeDeltaTime, except we let it be 0 sometimes
     //if we are vsynced, this should "not drift over time". so thats how we detect vsync
@@ -267,48 +686,40 @@ void SDL_Internal_SwapBuffersAndMeasureTime_NonDXGI(SDL_Window* window) {
     frame_timing_info_ndxgi.snap_error /= 2; //decay previous snap error
     frame_timing_info_ndxgi.snap_error += delta - snapped_delta;
 
-    //track realtime / snapped time drift over last 128 refreshes using a circular buffer of recorded times
-    int index = (frame_timing_info_ndxgi.drift_detection_index++)%frame_timing_info_ndxgi.drift_detection_window;
-    frame_timing_info_ndxgi.snapped_total -= frame_timing_info_ndxgi.snapped_deltas[index];
-    frame_timing_info_ndxgi.realtime_total -= frame_timing_info_ndxgi.realtime_deltas[index];
-    frame_timing_info_ndxgi.snapped_deltas[index] = snapped_delta;
-    frame_timing_info_ndxgi.realtime_deltas[index] = delta;
-    frame_timing_info_ndxgi.snapped_total += frame_timing_info_ndxgi.snapped_deltas[index];
-    frame_timing_info_ndxgi.realtime_total += frame_timing_info_ndxgi.realtime_deltas[index];
+    //track realtime / snapped time drift over the last config.window refreshes, with a longer history behind it for the statistics
+    DriftWindow* drift_window = &frame_drift_history_info.window;
+    DriftWindowPush(drift_window, delta - snapped_delta);
 
     //if we are vsynced, the drift should remain small
-    int64_t drift = frame_timing_info_ndxgi.realtime_total - frame_timing_info_ndxgi.snapped_total;
-
-    double error_range = .005; //5ms range for vsync detection (dont know if theres a better way to determine a threshold here, 5ms seems like enough to absorb one-frame measurement error)
-    if(frame_timing_info_ndxgi.drift_detection_index < frame_timing_info_ndxgi.drift_detection_window) {
-        error_range = .1; //if we havent recorded enough frames, 100ms error range instead (this should diverge fast if not actually vsynced, so we dont have to wait too long)
+    int64_t drift = drift_window->drift;
+
+    //unless the refresh period we snap to is slightly off (rounded refresh rate, a display running a little fast), then drift grows at a steady rate
+    //with no frame ever landing far off the grid. real vsync loss never looks that tidy, so take the steady part out and only judge the rest
+    DriftWindowStats stats;
+    DriftWindowComputeStats(drift_window, monitor_refresh_period / 4.0, &stats);
+    double max_refresh_error = frame_timing_info_ndxgi.estimator.config.max_refresh_error;
+    if(stats.count == drift_window->length && stats.outliers == 0 && fabs(stats.slope) < monitor_refresh_period * max_refresh_error) {
+        int drift_frames = drift_window->drift_length < stats.count?drift_window->drift_length:stats.count;
+        drift -= (int64_t)(stats.slope * drift_frames);
     }
 
-    bool probably_vsynced = abs(drift) < error_range * frame_timing_info.clocks_per_second;
-    bool prev_vsynced = frame_timing_info_ndxgi.is_actually_vsynced;
-
-    //this bit is copied from my DXGI stuff, because of random spikes the drift can be "off" sometimes, but usually resolved on the next frame. 
-    //we wanna make sure we detect "not vsynced" for a few frames in a row before deciding thats the case
+    //the estimator wants to see a few "not vsynced" frames in a row before deciding thats the case (random spikes)
     //note that if you change modes it can take some time for this detection to kick in (when going from non-vsynced to vsynced)
-    //for that reason it might be useful to flush these buffers if the application changes vsync manually
-    if(frame_timing_info_ndxgi.is_actually_vsynced) {
-        frame_timing_info_ndxgi.is_vsynced_estimator += probably_vsynced?-1:1;
-        if(frame_timing_info_ndxgi.is_vsynced_estimator < 0) frame_timing_info_ndxgi.is_vsynced_estimator = 0;
-        if(frame_timing_info_ndxgi.is_vsynced_estimator >= 4) { //net +4 unsynced frames, we aren't vsynced
-            frame_timing_info_ndxgi.is_actually_vsynced = false;
-
-            frame_timing_info_ndxgi.is_vsynced_estimator = 0;
-        }
-    } else {
-        frame_timing_info_ndxgi.is_vsynced_estimator += probably_vsynced?1:-1;
-        if(frame_timing_info_ndxgi.is_vsynced_estimator < 0) frame_timing_info_ndxgi.is_vsynced_estimator = 0;
-        if(frame_timing_info_ndxgi.is_vsynced_estimator >= 16) { //net +16 vsynced frames, we are probably vsynced
-            frame_timing_info_ndxgi.is_actually_vsynced = true;
-
-            frame_timing_info_ndxgi.is_vsynced_estimator = 0;
-        }
+    //for that reason SDL_FramePacing_NotifySwapIntervalChanged flushes these buffers when the application changes vsync manually
+    if(frame_timing_info_ndxgi.detection_grace > 0) {
+        frame_timing_info_ndxgi.detection_grace--;
+        return;
     }
 
+    double clocks = frame_timing_info.clocks_per_second;
+    VsyncEstimatorSample sample;
+    sample.error = drift / clocks;
+    sample.tolerance_scale = 1;
+    sample.residual = est_vsyncs == 0?monitor_refresh_period / (2*clocks):(delta - snapped_delta) / clocks; //a swap that returned within half a refresh never waited for one
+    sample.refresh_period = monitor_refresh_period / clocks;
+    sample.definitely_not_vsynced = false;
+    VsyncEstimatorUpdate(&frame_timing_info_ndxgi.estimator, &sample);
+
     //Note: with variable rate refresh, if rendering takes "about as much time as 1 frame" (test this by putting a SDL_Delay in game_render(), 
     //this can keep swapping between vsynced and non-vsynced timings and the frame pacing ends up kind of jittery,
     //any frames > 1 refresh period behave as non-vsynced, and any frames < 1 refresh period behave as vsynced
@@ -317,22 +728,50 @@ void SDL_Internal_SwapBuffersAndMeasureTime_NonDXGI(SDL_Window* window) {
 
 void SDL_Internal_FramePacing_ComputeDeltaTime(DXGISwapChainAdapter* swapchain) {
     bool is_vsynced; int64_t current_frametime; int64_t monitor_refresh_period;
+    int64_t refresh_numerator, refresh_denominator;
+    get_refresh_rate(swapchain, &refresh_numerator, &refresh_denominator);
+    monitor_refresh_period = frame_timing_info.clocks_per_second * refresh_denominator / refresh_numerator;
+
+    int frame_latency = 1;
     if(swapchain) {
         is_vsynced = DXGISwapChainAdapterIsActuallyVsynced(swapchain);
         current_frametime = DXGISwapChainAdapterGetPresentTimestamp(swapchain);
-        monitor_refresh_period = frame_timing_info.clocks_per_second / DXGISwapChainAdapterRefreshRate(swapchain);
+        frame_timing_info.swap_wait_time = DXGISwapChainAdapterGetSwapWaitTime(swapchain);
+        frame_latency = DXGISwapChainAdapterGetFrameLatency(swapchain);
+
+        Uint64 missed_presents = DXGISwapChainAdapterGetMissedPresents(swapchain);
+        //the total only goes backwards when its source changed under us (present thread toggled), count on from the new value
+        frame_timing_info.missed_refreshes = missed_presents > frame_timing_info.dxgi_missed_presents?(int)(missed_presents - frame_timing_info.dxgi_missed_presents):0;
+        frame_timing_info.dxgi_missed_presents = missed_presents;
     } else {
-        is_vsynced = frame_timing_info_ndxgi.is_actually_vsynced;
+        is_vsynced = frame_timing_info_ndxgi.estimator.is_vsynced;
         current_frametime = frame_timing_info_ndxgi.swap_time;
-        monitor_refresh_period = frame_timing_info.clocks_per_second / frame_timing_info_ndxgi.window_refresh_rate;
+        frame_timing_info.swap_wait_time = frame_timing_info_ndxgi.swap_duration;
+        frame_timing_info.missed_refreshes = 0; //worked out from the snapped delta below
     }
 
+    //snapping works on deltas between presents, which a deeper queue only delays but doesnt change
+    //what it does change is how far in the future this frame will be shown, every queued frame is one more refresh (or measured frame) between us and the display
+    //idle pacing presents every few refreshes, the last swap used the same multiple the next one most likely will
+    //with frame generation every real frame is followed by generated_frames synthesized presents, so a real frame spans that many more refreshes
+    //current_frametime is the last (synthesized) present, the real frame being built now is the next one out and its generated frames follow one present apart
+    int frames_per_update = 1 + frame_timing_info.generated_frames;
+    int64_t display_period = is_vsynced?monitor_refresh_period * frame_idle_info.refresh_multiple * frames_per_update:frame_timing_info.non_vsync_smoother;
+    frame_timing_info.present_interval = display_period / frames_per_update;
+    frame_timing_info.predicted_display_time = current_frametime + frame_timing_info.present_interval * frame_latency;
+
     int64_t delta_time = current_frametime - frame_timing_info.prev_frame_time;
 
-    if(frame_timing_info.prev_frame_time == 0) { //first update, just report 1 vsync time
-        delta_time = monitor_refresh_period;
+    if(frame_timing_info.prev_frame_time == 0) { //first update, just report 1 vsync time (one per present with frame generation)
+        delta_time = monitor_refresh_period * frames_per_update;
     }
     frame_timing_info.prev_frame_time = current_frametime;
+    frame_timing_info.frame_timestamp = current_frametime;
+    frame_timing_info.refresh_period = monitor_refresh_period;
+    frame_timing_info.measured_delta_time = delta_time;
+    frame_timing_info.expected_delta_time = display_period;
+    frame_timing_info.is_vsynced = is_vsynced;
+    frame_timing_info.typical_swap_wait += (frame_timing_info.swap_wait_time - frame_timing_info.typical_swap_wait) / 64;
     frame_timing_info.drift -= delta_time;
 
     if(is_vsynced) {
@@ -342,10 +781,21 @@ void SDL_Internal_FramePacing_ComputeDeltaTime(DXGISwapChainAdapter* swapchain)
         //     these sum up to 2 frames worth of time usually, I think, so I think its just an OS scheduling thing messing up when the time is recorded internally
         //     snap_error is meant to smooth this out slightly, though is not meant to compensate over the long term, so it decays
         
+        //at least one refresh: frames much shorter than a refresh (vsync not actually on yet) pile up negative snap error,
+        //which would otherwise round to a negative frame time and run the timeline backwards
         int est_vsyncs = round((double)(delta_time+frame_timing_info.snap_error) / monitor_refresh_period);
-        if(est_vsyncs == 0) est_vsyncs = 1;
+        if(est_vsyncs < 1) est_vsyncs = 1;
 
-        int64_t snapped_time = monitor_refresh_period * est_vsyncs;
+        //single refresh frames are the cleanest measurement of the real vblank period, average them slowly
+        if(est_vsyncs == 1) {
+            if(frame_timing_info.measured_refresh_period == 0) frame_timing_info.measured_refresh_period = delta_time;
+            frame_timing_info.measured_refresh_period += (delta_time - frame_timing_info.measured_refresh_period) / 64;
+        }
+        //without DXGI frame statistics, refreshes beyond what the frame was expected to span are the ones it missed
+        int expected_vsyncs = frame_idle_info.refresh_multiple * frames_per_update;
+        if(!swapchain && est_vsyncs > expected_vsyncs) frame_timing_info.missed_refreshes = est_vsyncs - expected_vsyncs;
+
+        int64_t snapped_time = refresh_periods_to_clocks(est_vsyncs, refresh_numerator, refresh_denominator);
         frame_timing_info.snap_error /= 2; //decay previous snap error
         frame_timing_info.snap_error += delta_time - snapped_time;
 
@@ -369,12 +819,599 @@ void SDL_Internal_FramePacing_ComputeDeltaTime(DXGISwapChainAdapter* swapchain)
 
     frame_timing_info.delta_time = delta_time;
     frame_timing_info.drift += delta_time;
+    frame_timing_info.delta_time_ns = fixed_point_multiply(delta_time, frame_timing_info.clocks_to_ns, &frame_timing_info.ns_carry);
+    frame_timing_info.timeline_ns += frame_timing_info.delta_time_ns;
+
+    if(FrameRecorderIsOpen()) {
+        FrameRecord* record = &frame_recording_info.pending;
+        frame_recording_info.has_pending = true;
+        memset(record, 0, sizeof(FrameRecord));
+        record->timestamp = current_frametime;
+        if(swapchain) {
+            FrameStatistics stats = DXGISwapChainAdapterGetFrameStatistics(swapchain);
+            record->sync_time = stats.sync_time;
+            record->present_count = stats.present_count;
+            record->present_refresh_count = stats.present_refresh_count;
+            record->sync_refresh_count = stats.sync_refresh_count;
+        }
+        record->measured_delta = frame_timing_info.measured_delta_time;
+        record->reported_delta = delta_time;
+        record->expected_delta = frame_timing_info.expected_delta_time;
+        record->vsynced = is_vsynced;
+    }
+}
+
+static void reset_drift_window() {
+    DriftWindowReset(&frame_drift_history_info.window);
+    frame_timing_info_ndxgi.snap_error = 0;
+}
+
+void SDL_FramePacing_SetVsyncEstimatorConfig(const VsyncEstimatorConfig* config) {
+    VsyncEstimatorSetConfig(&frame_timing_info_ndxgi.estimator, config);
+
+    //the drift totals only mean something over a full window, so changing its length starts over
+    DriftWindow* drift_window = &frame_drift_history_info.window;
+    int history = config->history;
+    if(history < 1) history = 1;
+    if(history > drift_window->max_length) history = drift_window->max_length;
+    int window = config->window;
+    if(window < 1) window = 1;
+    if(window > history) window = history;
+    if(history != drift_window->length || window != drift_window->drift_length) {
+        DriftWindowInit(drift_window, history, window);
+        frame_timing_info_ndxgi.snap_error = 0;
+    }
+}
+
+//flush everything that was learned in the old mode, and seed it with what we know about the new one
+static void reset_vsync_detection(DXGISwapChainAdapter* swapchain, bool assume_vsynced) {
+    if(swapchain) {
+        DXGISwapChainAdapterResetVsyncDetection(swapchain, assume_vsynced);
+    } else {
+        reset_drift_window();
+        VsyncEstimatorReset(&frame_timing_info_ndxgi.estimator, assume_vsynced);
+        frame_timing_info_ndxgi.estimator.frames = frame_timing_info_ndxgi.estimator.config.warmup_frames; //the app told us the mode, so skip the loose warmup range
+        frame_timing_info_ndxgi.detection_grace = 1;
+    }
+
+    frame_timing_info.snap_error = 0;
+    frame_timing_info.non_vsync_error = 0;
+    frame_timing_info.refresh_period_remainder = 0;
+
+    //a vsynced smoother tracks the refresh period, so start it at one refresh of the new mode rather than whatever the old mode was running at
+    //a non vsynced one tracks how long our frames take, which the mode change didnt affect
+    if(assume_vsynced) {
+        int64_t refresh_numerator, refresh_denominator;
+        get_refresh_rate(swapchain, &refresh_numerator, &refresh_denominator);
+        frame_timing_info.non_vsync_smoother = frame_timing_info.clocks_per_second * refresh_denominator / refresh_numerator;
+    }
+}
+
+void SDL_FramePacing_NotifySwapIntervalChanged(DXGISwapChainAdapter* swapchain, int swap_interval) {
+    reset_vsync_detection(swapchain, swap_interval != 0);
+}
+
+static void set_refresh_rate(DXGISwapChainAdapter* swapchain, int64_t numerator, int64_t denominator) {
+    if(swapchain) {
+        DXGISwapChainAdapterSetRefreshRate(swapchain, numerator, denominator);
+    } else {
+        frame_timing_info_ndxgi.refresh_numerator = numerator;
+        frame_timing_info_ndxgi.refresh_denominator = denominator;
+    }
+}
+
+//the accumulator is measured in real time, not in refreshes, so it stays valid across the change
+//everything that was snapped or smoothed against the old refresh period gets reset / reseeded instead
+static void on_refresh_rate_changed(DXGISwapChainAdapter* swapchain) {
+    bool was_vsynced = swapchain?DXGISwapChainAdapterIsActuallyVsynced(swapchain):frame_timing_info_ndxgi.estimator.is_vsynced;
+    reset_vsync_detection(swapchain, was_vsynced);
+}
+
+void SDL_FramePacing_NotifyRefreshRateChanged(DXGISwapChainAdapter* swapchain, double refresh_rate) {
+    int64_t numerator, denominator;
+    refresh_rate_to_rational(refresh_rate, &numerator, &denominator);
+    set_refresh_rate(swapchain, numerator, denominator);
+    on_refresh_rate_changed(swapchain);
+}
+
+static Uint64 display_profile_key(SDL_Window* window) {
+    SDL_DisplayID display = SDL_GetDisplayForWindow(window);
+    const SDL_DisplayMode* mode = SDL_GetCurrentDisplayMode(display);
+    if(!mode) return 0;
+    return DisplayProfileCacheKey(SDL_GetDisplayName(display), mode->w, mode->h, mode->refresh_rate, mode->pixel_density);
+}
+
+bool SDL_FramePacing_LoadDisplayProfile(SDL_Window* window, DXGISwapChainAdapter* swapchain, int swap_interval, const char* path) {
+    DisplayProfileCacheLoad(path);
+
+    DisplayTimingProfile profile;
+    if(!DisplayProfileCacheFind(display_profile_key(window), &profile)) return false;
+
+    double clocks = frame_timing_info.clocks_per_second;
+    if(profile.refresh_period > 0) {
+        //the mode often reports a rounded rate (60 for a 59.94hz panel), trust the measurement if its close to what the mode says
+        int64_t refresh_numerator, refresh_denominator;
+        get_refresh_rate(swapchain, &refresh_numerator, &refresh_denominator);
+        double reported_rate = (double)refresh_numerator / refresh_denominator;
+        double measured_rate = 1.0 / profile.refresh_period;
+        if(fabs(measured_rate - reported_rate) < reported_rate * .01) {
+            refresh_rate_to_rational(measured_rate, &refresh_numerator, &refresh_denominator);
+            set_refresh_rate(swapchain, refresh_numerator, refresh_denominator);
+        }
+        frame_timing_info.measured_refresh_period = profile.refresh_period * clocks;
+    }
+    frame_timing_info.typical_swap_wait = profile.present_latency * clocks;
+
+    //start from last runs decision, and skip the loose warmup range since we already know this display
+    //a decision made under another interval says nothing about this one (vsync off last run, on now), so that gets the normal warmup
+    if(profile.swap_interval == swap_interval) reset_vsync_detection(swapchain, profile.vsynced);
+    return true;
+}
+
+bool SDL_FramePacing_SaveDisplayProfile(SDL_Window* window, DXGISwapChainAdapter* swapchain, int swap_interval, const char* path) {
+    Uint64 key = display_profile_key(window);
+    if(!key) return false;
+
+    double clocks = frame_timing_info.clocks_per_second;
+    DisplayTimingProfile profile;
+    profile.refresh_period = frame_timing_info.measured_refresh_period / clocks;
+    profile.present_latency = frame_timing_info.typical_swap_wait / clocks;
+    profile.swap_interval = swap_interval;
+    profile.vsynced = swapchain?DXGISwapChainAdapterIsActuallyVsynced(swapchain):frame_timing_info_ndxgi.estimator.is_vsynced;
+
+    DisplayProfileCacheLoad(path); //pick up entries for other displays, another instance may have written some
+    DisplayProfileCacheStore(key, &profile);
+    return DisplayProfileCacheSave(path);
+}
+
+void SDL_FramePacing_SetIdlePacing(int frames_before_idle, int idle_swap_interval) {
+    if(idle_swap_interval < 2) idle_swap_interval = 2;
+    if(idle_swap_interval > 4) idle_swap_interval = 4;
+    frame_idle_info.frames_before_idle = frames_before_idle;
+    frame_idle_info.idle_swap_interval = idle_swap_interval;
+}
+
+void SDL_FramePacing_ReportStateUnchanged() {
+    frame_idle_info.reported_unchanged = true;
+}
+
+bool SDL_FramePacing_IsIdle() {
+    return frame_idle_info.is_idle;
+}
+
+int SDL_FramePacing_GetSwapInterval(DXGISwapChainAdapter* swapchain, int swap_interval) {
+    FrameIdleInternal* idle = &frame_idle_info;
+    if(idle->saw_input || !idle->reported_unchanged) {
+        idle->unchanged_frames = 0;
+    } else {
+        idle->unchanged_frames++;
+    }
+    idle->saw_input = false;
+    idle->reported_unchanged = false;
+
+    idle->is_idle = idle->frames_before_idle > 0 && idle->unchanged_frames >= idle->frames_before_idle;
+    idle->refresh_multiple = 1;
+    if(!idle->is_idle) return swap_interval;
+
+    if(swap_interval > 0) {
+        //let the display do the waiting, presenting every Nth vblank keeps the frames on the refresh grid so snapping stays exact
+        idle->refresh_multiple = swap_interval > idle->idle_swap_interval?swap_interval:idle->idle_swap_interval;
+        return idle->refresh_multiple;
+    }
+
+    //vsync off would spin as fast as it can, sleep until the same idle rate instead
+    //the rate is between the ends of presents (frame_timestamp is where the last one returned), so wake up a typical swap wait early
+    int64_t refresh_numerator, refresh_denominator;
+    get_refresh_rate(swapchain, &refresh_numerator, &refresh_denominator);
+    int64_t deadline = frame_timing_info.frame_timestamp + frame_timing_info.clocks_per_second * refresh_denominator * idle->idle_swap_interval / refresh_numerator;
+    deadline -= (int64_t)frame_timing_info.typical_swap_wait;
+    int64_t now = pacer_clock();
+    if(now < deadline && !frame_clock_info.callback) SDL_DelayNS((Uint64)((deadline - now) * 1000000000.0 / frame_timing_info.clocks_per_second));
+    return swap_interval;
+}
+
+static bool is_input_event(const SDL_Event* event) {
+    //keyboard, text, mouse, joystick, gamepad and touch events all sit in this range
+    if(event->type >= SDL_EVENT_KEY_DOWN && event->type < SDL_EVENT_CLIPBOARD_UPDATE) return true;
+
+    //the window needs repainting, which counts as a change too
+    return event->type == SDL_EVENT_WINDOW_EXPOSED || event->type == SDL_EVENT_WINDOW_RESIZED || event->type == SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED;
+}
+
+void SDL_FramePacing_HandleEvent(SDL_Window* window, DXGISwapChainAdapter* swapchain, const SDL_Event* event) {
+    if(is_input_event(event)) frame_idle_info.saw_input = true;
+    if(event->type != SDL_EVENT_WINDOW_DISPLAY_CHANGED && event->type != SDL_EVENT_DISPLAY_CURRENT_MODE_CHANGED && event->type != SDL_EVENT_DISPLAY_DESKTOP_MODE_CHANGED) return;
+
+    if(swapchain) {
+        if(DXGISwapChainAdapterUpdateRefreshRate(swapchain)) on_refresh_rate_changed(swapchain);
+        return;
+    }
+
+    const SDL_DisplayMode* mode = SDL_GetCurrentDisplayMode(SDL_GetDisplayForWindow(window));
+    if(!mode) return;
+
+    int64_t numerator, denominator;
+    refresh_rate_to_rational(mode->refresh_rate, &numerator, &denominator);
+    if(numerator * frame_timing_info_ndxgi.refresh_denominator == frame_timing_info_ndxgi.refresh_numerator * denominator) return;
+
+    set_refresh_rate(NULL, numerator, denominator);
+    on_refresh_rate_changed(NULL);
 }
 
 Uint64 SDL_GetFrameTime() {
     return frame_timing_info.delta_time;
 }
+Uint64 SDL_GetPredictedDisplayTime() {
+    return frame_timing_info.predicted_display_time;
+}
+void SDL_FramePacing_SetFrameGeneration(int generated_frames) {
+    if(generated_frames < 0) generated_frames = 0;
+    if(generated_frames > 3) generated_frames = 3;
+    frame_timing_info.generated_frames = generated_frames;
+}
+int SDL_FramePacing_GetGeneratedFrameCount() {
+    return frame_timing_info.generated_frames;
+}
+Uint64 SDL_FramePacing_GetGeneratedFrameDisplayTime(int index) {
+    return frame_timing_info.predicted_display_time + frame_timing_info.present_interval * index;
+}
+Uint64 SDL_GetFrameTimeNS() {
+    return frame_timing_info.delta_time_ns;
+}
+Uint64 SDL_FramePacing_GetTimelineNS() {
+    return frame_timing_info.timeline_ns;
+}
+Uint64 SDL_FramePacing_ClocksToNS(Uint64 clocks) {
+    return fixed_point_multiply(clocks, frame_timing_info.clocks_to_ns, NULL);
+}
+Uint64 SDL_FramePacing_NSToClocks(Uint64 ns) {
+    return fixed_point_multiply(ns, frame_timing_info.ns_to_clocks, NULL);
+}
+static PFNGLGENQUERIESPROC glGenQueries_ptr;
+static PFNGLBEGINQUERYPROC glBeginQuery_ptr;
+static PFNGLENDQUERYPROC glEndQuery_ptr;
+static PFNGLGETQUERYOBJECTIVPROC glGetQueryObjectiv_ptr;
+static PFNGLGETQUERYOBJECTUI64VPROC glGetQueryObjectui64v_ptr;
+
+static void gl_create_queries(int count, unsigned int* queries, void* user_data) {
+    glGenQueries_ptr(count, queries);
+}
+static void gl_begin_query(unsigned int query, void* user_data) {
+    glBeginQuery_ptr(GL_TIME_ELAPSED, query);
+}
+static void gl_end_query(unsigned int query, void* user_data) {
+    glEndQuery_ptr(GL_TIME_ELAPSED);
+}
+static bool gl_get_query_result(unsigned int query, Uint64* nanoseconds, void* user_data) {
+    GLint available = 0;
+    glGetQueryObjectiv_ptr(query, GL_QUERY_RESULT_AVAILABLE, &available);
+    if(!available) return false;
+
+    GLuint64 result;
+    glGetQueryObjectui64v_ptr(query, GL_QUERY_RESULT, &result);
+    *nanoseconds = result;
+    return true;
+}
+
+void SDL_FramePacing_EnableGpuTiming(const SDL_FramePacingGpuQueryProvider* provider) {
+    memset(&frame_gpu_timing_info, 0, sizeof(frame_gpu_timing_info));
+
+    if(provider) {
+        frame_gpu_timing_info.provider = *provider;
+    } else {
+        glGenQueries_ptr = (PFNGLGENQUERIESPROC)SDL_GL_GetProcAddress("glGenQueries");
+        glBeginQuery_ptr = (PFNGLBEGINQUERYPROC)SDL_GL_GetProcAddress("glBeginQuery");
+        glEndQuery_ptr = (PFNGLENDQUERYPROC)SDL_GL_GetProcAddress("glEndQuery");
+        glGetQueryObjectiv_ptr = (PFNGLGETQUERYOBJECTIVPROC)SDL_GL_GetProcAddress("glGetQueryObjectiv");
+        glGetQueryObjectui64v_ptr = (PFNGLGETQUERYOBJECTUI64VPROC)SDL_GL_GetProcAddress("glGetQueryObjectui64v");
+        if(!glGenQueries_ptr || !glBeginQuery_ptr || !glEndQuery_ptr || !glGetQueryObjectiv_ptr || !glGetQueryObjectui64v_ptr) return; //no timer queries (GL < 3.3), leave it off
+
+        frame_gpu_timing_info.provider.create_queries = gl_create_queries;
+        frame_gpu_timing_info.provider.begin_query = gl_begin_query;
+        frame_gpu_timing_info.provider.end_query = gl_end_query;
+        frame_gpu_timing_info.provider.get_query_result = gl_get_query_result;
+    }
+
+    frame_gpu_timing_info.provider.create_queries(frame_gpu_timing_info.query_count, frame_gpu_timing_info.queries, frame_gpu_timing_info.provider.user_data);
+    frame_gpu_timing_info.enabled = true;
+}
+
+//reads back whatever finished, oldest first, and starts a new query if there is a free one
+//if the gpu is so far behind that every query is still pending, this frame just doesnt get measured
+static int gpu_timing_begin() {
+    if(!frame_gpu_timing_info.enabled) return -1;
+    FrameGpuTimingInternal* info = &frame_gpu_timing_info;
+
+    while(info->resolved < info->issued) {
+        Uint64 nanoseconds;
+        if(!info->provider.get_query_result(info->queries[info->resolved % info->query_count], &nanoseconds, info->provider.user_data)) break;
+        info->resolved++;
+
+        info->gpu_frame_time = (int64_t)((double)nanoseconds * frame_timing_info.clocks_per_second / 1000000000.0);
+        info->history[info->history_index] = info->gpu_frame_time;
+        info->history_index = (info->history_index + 1) % info->history_length;
+    }
+
+    if(info->issued - info->resolved >= (Uint64)info->query_count) return -1;
+
+    int query = info->issued % info->query_count;
+    info->provider.begin_query(info->queries[query], info->provider.user_data);
+    return query;
+}
+
+static void gpu_timing_end(int query) {
+    if(query < 0) return;
+    frame_gpu_timing_info.provider.end_query(frame_gpu_timing_info.queries[query], frame_gpu_timing_info.provider.user_data);
+    frame_gpu_timing_info.issued++;
+}
+
+double SDL_GetGpuFrameTime() {
+    return (double)frame_gpu_timing_info.gpu_frame_time / frame_timing_info.clocks_per_second;
+}
+
+static bool detect_hitch(SDL_FramePacing_HitchClass* hitch_class) {
+    int64_t measured = frame_timing_info.measured_delta_time;
+    int64_t expected = frame_timing_info.expected_delta_time;
+    if(!frame_hitch_info.has_phase_timings || expected <= 0) return false;
+    if(measured < expected * frame_hitch_info.threshold) return false;
+
+    //attribute the overrun to whichever phase ate the budget
+    //the swap wait normally soaks up whatever is left of the refresh, so it only counts as a stall when it alone blocked for more than a whole frame
+    SDL_FramePacingHitch hitch;
+    int64_t work = frame_hitch_info.sim_time + frame_hitch_info.render_time;
+    if(work > expected) {
+        hitch.hitch_class = frame_hitch_info.sim_time > frame_hitch_info.render_time?SDL_FRAMEPACING_HITCH_SIM_OVERRUN:SDL_FRAMEPACING_HITCH_RENDER_OVERRUN;
+    } else if(frame_gpu_timing_info.gpu_frame_time > expected) {
+        //cpu side fit, but the gpu is taking longer than a frame, which shows up as swap blocking. its a render overrun, just not one the cpu can see
+        hitch.hitch_class = SDL_FRAMEPACING_HITCH_RENDER_OVERRUN;
+    } else if(frame_timing_info.swap_wait_time > expected) {
+        hitch.hitch_class = SDL_FRAMEPACING_HITCH_PRESENT_STALL;
+    } else {
+        hitch.hitch_class = SDL_FRAMEPACING_HITCH_OS_SCHEDULING;
+    }
+
+    frame_hitch_info.counts[hitch.hitch_class]++;
+
+    if(frame_hitch_info.callback) {
+        double clocks = frame_timing_info.clocks_per_second;
+        hitch.measured_time = measured / clocks;
+        hitch.expected_time = expected / clocks;
+        hitch.sim_time = frame_hitch_info.sim_time / clocks;
+        hitch.render_time = frame_hitch_info.render_time / clocks;
+        hitch.swap_time = frame_timing_info.swap_wait_time / clocks;
+        hitch.gpu_time = frame_gpu_timing_info.gpu_frame_time / clocks;
+        frame_hitch_info.callback(&hitch, frame_hitch_info.user_data);
+    }
+    *hitch_class = hitch.hitch_class;
+    return true;
+}
+
+void SDL_FramePacing_SetHitchCallback(SDL_FramePacing_HitchCallback callback, void* user_data) {
+    frame_hitch_info.callback = callback;
+    frame_hitch_info.user_data = user_data;
+}
+void SDL_FramePacing_SetHitchThreshold(double threshold) {
+    frame_hitch_info.threshold = threshold;
+}
+Uint64 SDL_FramePacing_GetHitchCount(SDL_FramePacing_HitchClass hitch_class) {
+    return frame_hitch_info.counts[hitch_class];
+}
+
+SDL_FramePacingHeadroomConfig SDL_FramePacing_DefaultHeadroomConfig() {
+    SDL_FramePacingHeadroomConfig config;
+    config.target_load = .85;
+    config.dead_band = .1;
+    config.kp = .1;
+    config.ki = .01;
+    config.kd = .05;
+    config.smoothing = .1;
+    config.max_adjustment = .05;
+    return config;
+}
+
+void SDL_FramePacing_SetHeadroomConfig(const SDL_FramePacingHeadroomConfig* config) {
+    frame_headroom_info.config = *config;
+    frame_headroom_info.headroom.adjusting = false;
+    frame_headroom_info.headroom.adjustment = 0;
+}
+
+SDL_FramePacingHeadroom SDL_FramePacing_GetHeadroom() {
+    return frame_headroom_info.headroom;
+}
+
+//same inputs as detect_hitch, the phase timings of the previous frame against the delta measured at its present
+static void update_headroom() {
+    FrameHeadroomInternal* info = &frame_headroom_info;
+    SDL_FramePacingHeadroom* headroom = &info->headroom;
+    const SDL_FramePacingHeadroomConfig* config = &info->config;
+
+    //the budget is whole refreshes even without vsync, holding the refresh rate is the point
+    int64_t budget = frame_timing_info.refresh_period * frame_idle_info.refresh_multiple * (1 + frame_timing_info.generated_frames);
+    if(!frame_hitch_info.has_phase_timings || budget <= 0) return;
+
+    int64_t cost = frame_hitch_info.sim_time + frame_hitch_info.render_time;
+    if(frame_gpu_timing_info.gpu_frame_time > cost) cost = frame_gpu_timing_info.gpu_frame_time;
+    //with vsync the swap wait is idle time until the vblank, without it present blocks on a full queue / the compositor and that comes out of the frame
+    if(!frame_timing_info.is_vsynced) cost += (int64_t)frame_timing_info.typical_swap_wait;
+    double load = (double)cost / budget;
+
+    //the phases can all fit and the frame still miss (work landed late in the refresh, a gpu measurement from a few frames ago)
+    int missed = frame_timing_info.missed_refreshes;
+    headroom->missed_refreshes = missed;
+    if(missed > 0) {
+        headroom->total_missed_refreshes += missed;
+        double missed_load = 1 + (double)missed * frame_timing_info.refresh_period / budget;
+        if(load < missed_load) load = missed_load;
+    }
+    headroom->raw_load = load;
+
+    //a miss goes into the smoothed load at once, waiting for the average to catch up would only miss more frames
+    if(headroom->load == 0 || (missed > 0 && load > headroom->load)) headroom->load = load;
+    else headroom->load += (load - headroom->load) * config->smoothing;
+
+    double error = config->target_load - headroom->load;
+    if(headroom->adjusting && (error > 0) != (info->direction > 0)) headroom->adjusting = false; //back at the target
+    if(!headroom->adjusting && fabs(error) > config->dead_band) {
+        headroom->adjusting = true;
+        info->direction = error > 0?1:-1;
+        info->integral = 0;
+        info->prev_error = error;
+    }
+    if(!headroom->adjusting) {
+        headroom->adjustment = 0;
+        return;
+    }
+
+    //the integral is limited to what it could add on its own, so a long climb out of a heavy scene doesnt overshoot on the way back
+    info->integral += error;
+    if(config->ki > 0) {
+        double max_integral = config->max_adjustment / config->ki;
+        if(info->integral > max_integral) info->integral = max_integral;
+        if(info->integral < -max_integral) info->integral = -max_integral;
+    }
+    double adjustment = config->kp * error + config->ki * info->integral + config->kd * (error - info->prev_error);
+    info->prev_error = error;
+    if(adjustment > config->max_adjustment) adjustment = config->max_adjustment;
+    if(adjustment < -config->max_adjustment) adjustment = -config->max_adjustment;
+    headroom->adjustment = adjustment;
+}
+
+//recorded before the render callback so a HUD drawn from it already includes the current frame
+static void record_history(int ticks, double accumulator_fill) {
+    FrameHistoryInternal* history = &frame_history_info;
+    int i = history->index;
+    history->measured_delta[i] = frame_timing_info.measured_delta_time;
+    history->reported_delta[i] = frame_timing_info.delta_time;
+    history->expected_delta[i] = frame_timing_info.expected_delta_time;
+    history->accumulator_fill[i] = accumulator_fill;
+    history->vsynced[i] = frame_timing_info.is_vsynced;
+    history->ticks[i] = ticks;
+    history->index = (i + 1) % history->length;
+    if(history->count < history->length) history->count++;
+
+    if(FrameRecorderIsOpen() && frame_recording_info.has_pending) {
+        frame_recording_info.pending.ticks = ticks;
+        FrameRecorderAppend(&frame_recording_info.pending);
+    }
+    frame_recording_info.has_pending = false;
+}
+
+bool SDL_FramePacing_StartRecording(const char* path) {
+    frame_recording_info.has_pending = false; //a frame captured for a recording stopped since doesnt belong in this one
+    return FrameRecorderOpen(path, frame_timing_info.clocks_per_second);
+}
+
+void SDL_FramePacing_StopRecording() {
+    FrameRecorderClose();
+}
+
+//the pacing code keeps its own, clamp() above belongs to the sample and goes away with it
+static float hud_clamp(float v, float min, float max) {
+    if(v < min) v = min;
+    if(v > max) v = max;
+    return v;
+}
+
+void SDL_FramePacing_DrawHUD(QuadBatch* batch, float x, float y, float w, float h) {
+    const FrameHistoryInternal* history = &frame_history_info;
+    if(history->count == 0) return;
+
+    const Uint32 background = QuadBatchColor(0, 0, 0, .6);
+    const Uint32 measured_color = QuadBatchColor(.5, .5, .5, 1);
+    const Uint32 reported_color = QuadBatchColor(0, 1, 0, 1);
+    const Uint32 expected_color = QuadBatchColor(1, 1, 0, 1);
+    const Uint32 fill_color = QuadBatchColor(.3, .5, 1, 1);
+    const Uint32 synced_color = QuadBatchColor(0, .8, 0, 1);
+    const Uint32 unsynced_color = QuadBatchColor(.8, 0, 0, 1);
+    const Uint32 ticks_color = QuadBatchColor(1, .5, 0, 1);
+
+    //delta lane gets half the height, the rest split the other half
+    const float gap = 2;
+    float delta_h = h * .5f - gap;
+    float fill_h = h * .2f - gap;
+    float vsync_h = h * .1f - gap;
+    float ticks_h = h * .2f;
+    float delta_y = y;
+    float fill_y = delta_y + delta_h + gap;
+    float vsync_y = fill_y + fill_h + gap;
+    float ticks_y = vsync_y + vsync_h + gap;
+
+    QuadBatchPush(batch, x, y, w, h, background);
+
+    //scale the delta lane so the newest expected delta sits in the middle, a frame twice as long as expected hits the top
+    int newest = (history->index + history->length - 1) % history->length;
+    double delta_scale = history->expected_delta[newest] > 0?delta_h / (2.0 * history->expected_delta[newest]):0;
+    const int max_ticks = 4;
+
+    float column_w = w / history->length;
+    for(int n = 0; n < history->count; n++) {
+        //oldest on the left, newest on the right edge
+        int i = (history->index + history->length - history->count + n) % history->length;
+        float cx = x + w - (history->count - n) * column_w;
+
+        float measured = hud_clamp(history->measured_delta[i] * delta_scale, 0, delta_h);
+        float reported = hud_clamp(history->reported_delta[i] * delta_scale, 0, delta_h);
+        float expected = hud_clamp(history->expected_delta[i] * delta_scale, 0, delta_h);
+        QuadBatchPush(batch, cx, delta_y + delta_h - measured, column_w, measured, measured_color);
+        QuadBatchPush(batch, cx, delta_y + delta_h - reported, column_w, 1, reported_color);
+        QuadBatchPush(batch, cx, delta_y + delta_h - expected, column_w, 1, expected_color);
+
+        float fill = hud_clamp(history->accumulator_fill[i], 0, 1) * fill_h;
+        QuadBatchPush(batch, cx, fill_y + fill_h - fill, column_w, fill, fill_color);
+
+        QuadBatchPush(batch, cx, vsync_y, column_w, vsync_h, history->vsynced[i]?synced_color:unsynced_color);
+
+        if(history->ticks[i] > 0) {
+            float ticks = hud_clamp(history->ticks[i], 0, max_ticks) * ticks_h / max_ticks;
+            QuadBatchPush(batch, cx, ticks_y + ticks_h - ticks, column_w, ticks, ticks_color);
+        }
+    }
+}
+
+//ticks * 1e9 / rate without overflowing or losing the fraction, the rate is taken to the millihertz so 59.94 stays exact
+static Uint64 ticks_to_ns(Uint64 ticks, Uint64 rate_millihertz) {
+    const Uint64 ns_per_millihertz = 1000000000000ull;
+    return ticks / rate_millihertz * ns_per_millihertz + ticks % rate_millihertz * ns_per_millihertz / rate_millihertz;
+}
+
+//a tick is begin, the fixed update callback, then the partitions when there are any, then end. the context describes the running tick throughout
+static void fixed_update_tick_begin() {
+    SDL_FramePacingContext* context = &frame_pacing_info.context;
+    context->simulated_ticks++;
+    context->simulated_time = context->simulated_ticks * context->fixed_delta_time;
+    context->simulated_time_ns = ticks_to_ns(context->simulated_ticks, frame_pacing_info.update_rate_millihertz);
+}
+
+static void run_fixed_update_callback(SDL_FramePacingInfo* pacing_info) {
+    SDL_FramePacingContext* context = &frame_pacing_info.context;
+    if(pacing_info->fixed_update_callback_ex) {
+        pacing_info->fixed_update_callback_ex(context, pacing_info->user_data);
+    } else if(pacing_info->fixed_update_callback) {
+        pacing_info->fixed_update_callback(context->fixed_delta_time, pacing_info->user_data);
+    }
+}
+
+static void fixed_update_tick_end() {
+    frame_pacing_info.context.tick_index++;
+}
+
+//the pool runs both of these on this thread, the tick zone opens in the serial step and closes once every partition of the tick is done
+static void fixed_update_serial_step(double delta_time, void* data) {
+    FrameTraceBeginZone("fixed update");
+    fixed_update_tick_begin();
+    run_fixed_update_callback(frame_pacing_info.running_info);
+}
+
+static void fixed_update_post_tick(double delta_time, void* data) {
+    fixed_update_tick_end();
+    FrameTraceEndZone();
+}
+
 void SDL_PaceFrame(Uint64 delta_time, SDL_FramePacingInfo* pacing_info) {
+    SDL_FramePacingContext* context = &frame_pacing_info.context;
+    context->hitched = detect_hitch(&context->hitch_class);
+    update_headroom();
+
     Uint64 desired_frame_time = frame_timing_info.clocks_per_second / pacing_info->update_rate;
     if(delta_time > frame_timing_info.clocks_per_second * .25) { //more than 1/4th of a second, this is a hitch and we should just do one frame
         delta_time = desired_frame_time;
@@ -384,13 +1421,111 @@ void SDL_PaceFrame(Uint64 delta_time, SDL_FramePacingInfo* pacing_info) {
     frame_pacing_info.accumulator += delta_time;
     int64_t consumedDeltaTime = delta_time;
 
+    int ticks = 0;
     while(frame_pacing_info.accumulator > desired_frame_time) {
         frame_pacing_info.accumulator -= desired_frame_time;
-        pacing_info->fixed_update_callback(1.0/pacing_info->update_rate, pacing_info->user_data);
+        ticks++;
+    }
+
+    //everything below is known up front, so the callbacks share one copy instead of each requerying it
+    double clocks = frame_timing_info.clocks_per_second;
+    context->frame_timestamp = frame_timing_info.frame_timestamp;
+    context->predicted_display_time = frame_timing_info.predicted_display_time;
+    context->clocks_per_second = frame_timing_info.clocks_per_second;
+    context->delta_time = (double)delta_time / clocks;
+    context->fixed_delta_time = 1.0/pacing_info->update_rate;
+    frame_pacing_info.update_rate_millihertz = (Uint64)llround(pacing_info->update_rate * 1000.0);
+    context->fixed_delta_time_ns = ticks_to_ns(1, frame_pacing_info.update_rate_millihertz);
+    //the timeline is in the reported delta unless the hitch clamp above replaced it
+    context->delta_time_ns = (int64_t)delta_time == frame_timing_info.delta_time?frame_timing_info.delta_time_ns:SDL_FramePacing_ClocksToNS(delta_time);
+    context->timeline_ns = frame_timing_info.timeline_ns;
+    context->tick_count = ticks;
+    context->tick_index = 0;
+    context->frame_percent = (double)frame_pacing_info.accumulator / desired_frame_time;
+    context->refresh_period = frame_timing_info.refresh_period / clocks;
+    context->vsynced = frame_timing_info.is_vsynced;
+    context->idle = frame_idle_info.is_idle;
+    context->generated_frames = frame_timing_info.generated_frames;
+    context->present_interval = frame_timing_info.present_interval;
+    context->gpu_time = frame_gpu_timing_info.gpu_frame_time / clocks;
+    context->load = frame_headroom_info.headroom.load;
+    context->quality_adjustment = frame_headroom_info.headroom.adjustment;
+
+    //the sim phase is only the app's update callbacks, pacing bookkeeping and the history / recorder below dont count against it
+    int64_t sim_start = pacer_clock();
+    if(pacing_info->partition_count > 0) {
+        //all of this frames ticks in one run, so catch-up ticks dont pay for waking the workers again
+        if(!frame_pacing_info.worker_pool) frame_pacing_info.worker_pool = CreateFixedUpdatePool(frame_pacing_info.worker_threads);
+        frame_pacing_info.running_info = pacing_info;
+        FixedUpdatePoolRun(frame_pacing_info.worker_pool, ticks, pacing_info->partition_count, pacing_info->partition_update_callback,
+            fixed_update_serial_step, fixed_update_post_tick, context->fixed_delta_time, pacing_info->user_data);
+    } else {
+        for(int i = 0; i < ticks; i++) {
+            FRAME_TRACE_ZONE("fixed update");
+            fixed_update_tick_begin();
+            run_fixed_update_callback(pacing_info);
+            fixed_update_tick_end();
+        }
+    }
+
+    if(consumedDeltaTime > 0) {
+        FRAME_TRACE_ZONE("variable update");
+        if(pacing_info->variable_update_callback_ex) {
+            pacing_info->variable_update_callback_ex(context, pacing_info->user_data);
+        } else {
+            pacing_info->variable_update_callback((double)consumedDeltaTime / clocks, pacing_info->user_data);
+        }
+    }
+
+    int64_t sim_end = pacer_clock();
+
+    record_history(ticks, context->frame_percent);
+
+    int64_t render_start = pacer_clock();
+    {
+        FRAME_TRACE_ZONE("render");
+        int gpu_query = gpu_timing_begin();
+        if(pacing_info->render_callback_ex) {
+            pacing_info->render_callback_ex(context, pacing_info->user_data);
+        } else {
+            pacing_info->render_callback(context->delta_time, context->frame_percent, pacing_info->user_data);
+        }
+        gpu_timing_end(gpu_query);
     }
+    int64_t render_end = pacer_clock();
+
+    frame_hitch_info.sim_time = sim_end - sim_start;
+    frame_hitch_info.render_time = render_end - render_start;
+    frame_hitch_info.has_phase_timings = true;
+    context->frame_index++;
+}
 
-    if(consumedDeltaTime > 0) pacing_info->variable_update_callback((double)consumedDeltaTime / frame_timing_info.clocks_per_second, pacing_info->user_data);
-    pacing_info->render_callback((double)delta_time / frame_timing_info.clocks_per_second, (double)frame_pacing_info.accumulator / desired_frame_time, pacing_info->user_data);
+void SDL_FramePacing_SetWorkerThreads(int thread_count) {
+    //the pool is rebuilt with the new count on the next parallel frame
+    DestroyFixedUpdatePool(frame_pacing_info.worker_pool);
+    frame_pacing_info.worker_pool = NULL;
+    frame_pacing_info.worker_threads = thread_count;
+}
+
+//vblank / swap timestamps from whichever timing backend is active, as marker tracks in the frame trace
+//the DXGI adapter marks its Present calls itself (on the present thread when that is on), what we see here is the latency wait returning
+void SDL_Internal_FramePacing_TraceMarkers(DXGISwapChainAdapter* swapchain) {
+    static int64_t prev_vblank_time = 0;
+    static int64_t prev_swap_time = 0;
+
+    int64_t vblank_time = 0; int64_t swap_time;
+    if(swapchain) {
+        vblank_time = DXGISwapChainAdapterGetFrameStatistics(swapchain).sync_time;
+        swap_time = vblank_time + DXGISwapChainAdapterGetTimingMethodDelta(swapchain); //measured time the latency wait returned
+    } else {
+        swap_time = frame_timing_info_ndxgi.swap_time; //without DXGI we never see the vblank itself
+    }
+
+    //frame statistics repeat when nothing new was presented, only record each timestamp once
+    if(vblank_time != 0 && vblank_time != prev_vblank_time) FrameTraceMarker("vblank", vblank_time);
+    if(swap_time != 0 && swap_time != prev_swap_time) FrameTraceMarker(swapchain?"latency wait":"present", swap_time);
+    prev_vblank_time = vblank_time;
+    prev_swap_time = swap_time;
 }
 
 
@@ -398,15 +1533,31 @@ void SDL_Internal_FramePacing_Init(SDL_Window* window) {
     memset(&frame_timing_info, 0, sizeof(frame_timing_info));
     memset(&frame_pacing_info, 0, sizeof(frame_pacing_info));
     memset(&frame_timing_info_ndxgi, 0, sizeof(frame_timing_info_ndxgi));
+    memset(&frame_hitch_info, 0, sizeof(frame_hitch_info));
+    memset(&frame_gpu_timing_info, 0, sizeof(frame_gpu_timing_info));
+    memset(&frame_history_info, 0, sizeof(frame_history_info));
+    memset(&frame_drift_history_info, 0, sizeof(frame_drift_history_info));
+    memset(&frame_idle_info, 0, sizeof(frame_idle_info));
+    memset(&frame_headroom_info, 0, sizeof(frame_headroom_info));
+    frame_idle_info.refresh_multiple = 1;
+    frame_headroom_info.config = SDL_FramePacing_DefaultHeadroomConfig();
+    frame_hitch_info.threshold = 1.5;
 
     SDL_DisplayID display_index = SDL_GetDisplayForWindow(window);
     const SDL_DisplayMode* desktop = SDL_GetCurrentDisplayMode(display_index);
-    if(desktop) {
-        frame_timing_info_ndxgi.window_refresh_rate = desktop->refresh_rate;
-    } else {
-        frame_timing_info_ndxgi.window_refresh_rate = 0;
-    }
-    frame_timing_info_ndxgi.is_actually_vsynced = true;
+    int64_t refresh_numerator, refresh_denominator;
+    refresh_rate_to_rational(desktop?desktop->refresh_rate:0, &refresh_numerator, &refresh_denominator);
+    set_refresh_rate(NULL, refresh_numerator, refresh_denominator);
+    VsyncEstimatorConfig estimator_config = VsyncEstimatorDefaultConfig();
+    SDL_FramePacing_SetVsyncEstimatorConfig(&estimator_config);
+    frame_timing_info_ndxgi.estimator.is_vsynced = true; //initial guess should be to assume we are vsynced
+
+    frame_timing_info.clocks_per_second = frame_clock_info.callback?frame_clock_info.clocks_per_second:SDL_GetPerformanceFrequency();
+    frame_timing_info.clocks_to_ns = fixed_point_ratio(1000000000, frame_timing_info.clocks_per_second);
+    frame_timing_info.ns_to_clocks = fixed_point_ratio(frame_timing_info.clocks_per_second, 1000000000);
+}
 
-    frame_timing_info.clocks_per_second = SDL_GetPerformanceFrequency();
+void SDL_Internal_FramePacing_Shutdown() {
+    DestroyFixedUpdatePool(frame_pacing_info.worker_pool);
+    frame_pacing_info.worker_pool = NULL;
 }
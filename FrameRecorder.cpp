@@ -0,0 +1,308 @@
+#include "FrameRecorder.h"
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include "Windows.h"
+
+static const Uint32 frame_record_magic = 0x43525046; //"FPRC"
+static const Uint32 frame_record_version = 1;
+
+//record layout: one flags byte, then every field as a zigzag varint delta against the previous record
+//a keyframe is encoded against zero instead, every chunk starts with one so a dropped chunk doesnt corrupt the ones after it
+enum {
+    FRAME_RECORD_KEYFRAME = 1,
+    FRAME_RECORD_VSYNCED = 2,
+};
+static const int frame_record_field_count = 9;
+static const int frame_record_max_size = 1 + frame_record_field_count * 10;
+
+struct FrameRecordFileHeader {
+    Uint32 magic;
+    Uint32 version;
+    Sint64 clocks_per_second;
+};
+
+static void record_to_fields(const FrameRecord* record, int64_t* fields) {
+    fields[0] = record->timestamp;
+    fields[1] = record->sync_time;
+    fields[2] = record->present_count;
+    fields[3] = record->present_refresh_count;
+    fields[4] = record->sync_refresh_count;
+    fields[5] = record->measured_delta;
+    fields[6] = record->reported_delta;
+    fields[7] = record->expected_delta;
+    fields[8] = record->ticks;
+}
+
+static void fields_to_record(const int64_t* fields, FrameRecord* record) {
+    record->timestamp = fields[0];
+    record->sync_time = fields[1];
+    record->present_count = fields[2];
+    record->present_refresh_count = fields[3];
+    record->sync_refresh_count = fields[4];
+    record->measured_delta = fields[5];
+    record->reported_delta = fields[6];
+    record->expected_delta = fields[7];
+    record->ticks = fields[8];
+}
+
+static Uint8* write_varint(Uint8* out, int64_t value) {
+    Uint64 zigzag = ((Uint64)value << 1) ^ (Uint64)(value >> 63);
+    while(zigzag >= 0x80) {
+        *out++ = (Uint8)(zigzag | 0x80);
+        zigzag >>= 7;
+    }
+    *out++ = (Uint8)zigzag;
+    return out;
+}
+
+static const Uint8* read_varint(const Uint8* in, const Uint8* end, int64_t* value) {
+    Uint64 zigzag = 0;
+    for(int shift = 0; shift < 64; shift += 7) {
+        if(in == end) return NULL;
+        Uint8 byte = *in++;
+        zigzag |= (Uint64)(byte & 0x7f) << shift;
+        if(!(byte & 0x80)) {
+            *value = (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+            return in;
+        }
+    }
+    return NULL;
+}
+
+//writer
+
+static const int frame_recorder_chunk_count = 4;
+static const int frame_recorder_chunk_size = 64 * 1024;
+
+struct FrameRecorderInternal {
+    FILE* file;
+    std::thread writer;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stop;
+
+    Uint8* chunks[frame_recorder_chunk_count];
+    size_t chunk_sizes[frame_recorder_chunk_count];
+    bool chunk_free[frame_recorder_chunk_count];
+    int queue[frame_recorder_chunk_count]; //full chunks waiting for the writer, in order
+    int queue_start;
+    int queue_count;
+
+    //frame thread only
+    int active; //chunk being filled, -1 if the writer has all of them
+    int64_t previous[frame_record_field_count];
+    bool next_is_keyframe;
+    Uint64 dropped;
+} frame_recorder_info;
+
+static void writer_thread() {
+    FrameRecorderInternal* info = &frame_recorder_info;
+    std::unique_lock<std::mutex> lock(info->mutex);
+    while(true) {
+        info->wake.wait(lock, [info] { return info->queue_count > 0 || info->stop; });
+        if(info->queue_count == 0) break; //stopping and nothing left
+
+        int chunk = info->queue[info->queue_start];
+        info->queue_start = (info->queue_start + 1) % frame_recorder_chunk_count;
+        info->queue_count--;
+
+        lock.unlock();
+        fwrite(info->chunks[chunk], 1, info->chunk_sizes[chunk], info->file);
+        fflush(info->file);
+        lock.lock();
+
+        info->chunk_sizes[chunk] = 0;
+        info->chunk_free[chunk] = true;
+    }
+}
+
+bool FrameRecorderOpen(const char* path, int64_t clocks_per_second) {
+    FrameRecorderInternal* info = &frame_recorder_info;
+    if(info->file) return false;
+
+    info->file = fopen(path, "wb");
+    if(!info->file) return false;
+
+    FrameRecordFileHeader header;
+    header.magic = frame_record_magic;
+    header.version = frame_record_version;
+    header.clocks_per_second = clocks_per_second;
+    fwrite(&header, sizeof(header), 1, info->file);
+
+    for(int i = 0; i < frame_recorder_chunk_count; i++) {
+        info->chunks[i] = (Uint8*)malloc(frame_recorder_chunk_size);
+        info->chunk_sizes[i] = 0;
+        info->chunk_free[i] = i != 0;
+    }
+    info->active = 0;
+    info->queue_start = 0;
+    info->queue_count = 0;
+    info->next_is_keyframe = true;
+    info->dropped = 0;
+    info->stop = false;
+    info->writer = std::thread(writer_thread);
+    return true;
+}
+
+//hands the active chunk to the writer and picks up a free one, or -1 if they are all still queued
+static void submit_active_chunk() {
+    FrameRecorderInternal* info = &frame_recorder_info;
+    std::lock_guard<std::mutex> lock(info->mutex);
+
+    if(info->active >= 0) {
+        info->queue[(info->queue_start + info->queue_count) % frame_recorder_chunk_count] = info->active;
+        info->queue_count++;
+        info->active = -1;
+    }
+    for(int i = 0; i < frame_recorder_chunk_count; i++) {
+        if(!info->chunk_free[i]) continue;
+        info->chunk_free[i] = false;
+        info->active = i;
+        break;
+    }
+    info->next_is_keyframe = true;
+    info->wake.notify_one();
+}
+
+void FrameRecorderAppend(const FrameRecord* record) {
+    FrameRecorderInternal* info = &frame_recorder_info;
+    if(!info->file) return;
+
+    if(info->active < 0 || info->chunk_sizes[info->active] + frame_record_max_size > (size_t)frame_recorder_chunk_size) {
+        submit_active_chunk();
+        if(info->active < 0) {
+            info->dropped++;
+            return;
+        }
+    }
+
+    int64_t fields[frame_record_field_count];
+    record_to_fields(record, fields);
+
+    Uint8* start = info->chunks[info->active] + info->chunk_sizes[info->active];
+    Uint8* out = start;
+    *out++ = (info->next_is_keyframe?FRAME_RECORD_KEYFRAME:0) | (record->vsynced?FRAME_RECORD_VSYNCED:0);
+    if(info->next_is_keyframe) memset(info->previous, 0, sizeof(info->previous));
+    for(int i = 0; i < frame_record_field_count; i++) {
+        out = write_varint(out, fields[i] - info->previous[i]);
+        info->previous[i] = fields[i];
+    }
+    info->chunk_sizes[info->active] += out - start;
+    info->next_is_keyframe = false;
+}
+
+void FrameRecorderClose() {
+    FrameRecorderInternal* info = &frame_recorder_info;
+    if(!info->file) return;
+
+    if(info->active >= 0 && info->chunk_sizes[info->active] > 0) submit_active_chunk();
+    {
+        std::lock_guard<std::mutex> lock(info->mutex);
+        info->stop = true;
+        info->wake.notify_one();
+    }
+    info->writer.join();
+
+    fclose(info->file);
+    info->file = NULL;
+    for(int i = 0; i < frame_recorder_chunk_count; i++) {
+        free(info->chunks[i]);
+        info->chunks[i] = NULL;
+    }
+}
+
+bool FrameRecorderIsOpen() {
+    return frame_recorder_info.file != NULL;
+}
+
+Uint64 FrameRecorderDroppedRecords() {
+    return frame_recorder_info.dropped;
+}
+
+//reader
+
+struct FrameRecordReader {
+    HANDLE file;
+    HANDLE mapping;
+    const Uint8* data;
+    const Uint8* cursor;
+    const Uint8* end;
+    int64_t clocks_per_second;
+    int64_t previous[frame_record_field_count];
+};
+
+FrameRecordReader* FrameRecordReaderOpen(const char* path) {
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(file == INVALID_HANDLE_VALUE) return NULL;
+
+    LARGE_INTEGER size;
+    if(!GetFileSizeEx(file, &size) || size.QuadPart < (LONGLONG)sizeof(FrameRecordFileHeader)) {
+        CloseHandle(file);
+        return NULL;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    const Uint8* data = mapping?(const Uint8*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0):NULL;
+    if(!data) {
+        if(mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return NULL;
+    }
+
+    FrameRecordFileHeader header;
+    memcpy(&header, data, sizeof(header));
+    if(header.magic != frame_record_magic || header.version != frame_record_version) {
+        UnmapViewOfFile(data);
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return NULL;
+    }
+
+    FrameRecordReader* reader = (FrameRecordReader*)malloc(sizeof(FrameRecordReader));
+    memset(reader, 0, sizeof(FrameRecordReader));
+    reader->file = file;
+    reader->mapping = mapping;
+    reader->data = data;
+    reader->cursor = data + sizeof(header);
+    reader->end = data + size.QuadPart;
+    reader->clocks_per_second = header.clocks_per_second;
+    return reader;
+}
+
+void FrameRecordReaderClose(FrameRecordReader* reader) {
+    if(!reader) return;
+    UnmapViewOfFile(reader->data);
+    CloseHandle(reader->mapping);
+    CloseHandle(reader->file);
+    free(reader);
+}
+
+int64_t FrameRecordReaderClocksPerSecond(FrameRecordReader* reader) {
+    return reader->clocks_per_second;
+}
+
+bool FrameRecordReaderNext(FrameRecordReader* reader, FrameRecord* record) {
+    if(reader->cursor >= reader->end) return false;
+
+    const Uint8* in = reader->cursor;
+    Uint8 flags = *in++;
+    if(flags & FRAME_RECORD_KEYFRAME) memset(reader->previous, 0, sizeof(reader->previous));
+
+    int64_t fields[frame_record_field_count];
+    for(int i = 0; i < frame_record_field_count; i++) {
+        int64_t delta;
+        in = read_varint(in, reader->end, &delta);
+        if(!in) return false;
+        fields[i] = reader->previous[i] + delta;
+    }
+
+    memcpy(reader->previous, fields, sizeof(fields));
+    reader->cursor = in;
+    fields_to_record(fields, record);
+    record->vsynced = (flags & FRAME_RECORD_VSYNCED) != 0;
+    return true;
+}
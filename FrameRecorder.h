@@ -0,0 +1,34 @@
+#pragma once
+#include <SDL3/SDL.h>
+
+//long running capture of raw frame timings and what the pacer did with them, for offline analysis
+//records are delta encoded against the previous record as zigzag varints, a typical 240hz frame takes ~15 bytes
+//the frame thread only encodes into a memory chunk, full chunks are handed to a background thread which does the file writes
+//if the disk cant keep up, whole chunks are dropped (and counted) rather than stalling the frame
+
+struct FrameRecord {
+    int64_t timestamp; //frame time the pacer used, SDL_GetPerformanceCounter units
+    int64_t sync_time; //FrameStatistics, 0 without DXGI
+    int64_t present_count;
+    int64_t present_refresh_count;
+    int64_t sync_refresh_count;
+    int64_t measured_delta; //clocks
+    int64_t reported_delta; //clocks, after snapping / smoothing
+    int64_t expected_delta; //clocks
+    int64_t ticks; //fixed updates run this frame
+    bool vsynced; //estimator state
+};
+
+bool FrameRecorderOpen(const char* path, int64_t clocks_per_second);
+void FrameRecorderClose(); //flushes everything and joins the writer thread
+bool FrameRecorderIsOpen();
+void FrameRecorderAppend(const FrameRecord* record);
+Uint64 FrameRecorderDroppedRecords();
+
+//reader, maps the whole file and decodes records in order
+struct FrameRecordReader;
+
+FrameRecordReader* FrameRecordReaderOpen(const char* path);
+void FrameRecordReaderClose(FrameRecordReader* reader);
+int64_t FrameRecordReaderClocksPerSecond(FrameRecordReader* reader);
+bool FrameRecordReaderNext(FrameRecordReader* reader, FrameRecord* record); //false at the end (or at a record cut off by a crash)
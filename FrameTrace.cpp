@@ -0,0 +1,181 @@
+#include "FrameTrace.h"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+struct FrameTraceEvent {
+    const char* name; //zone name, or track name for markers
+    int64_t start;
+    int64_t end; //-1 for markers
+};
+
+struct FrameTraceThreadBuffer {
+    FrameTraceEvent* events;
+    int64_t write_index; //total events written, the ring holds the last events_per_thread of them
+
+    static const int max_zone_depth = 32;
+    const char* zone_names[max_zone_depth];
+    int64_t zone_starts[max_zone_depth];
+    int zone_depth;
+};
+
+static const int frame_trace_max_threads = 32;
+
+struct FrameTraceInternal {
+    int events_per_thread;
+    int64_t start_time;
+    int64_t clocks_per_second;
+
+    //a slot is claimed by bumping buffer_count, its pointer is only published once the buffer is ready, so readers skip NULL slots
+    std::atomic<FrameTraceThreadBuffer*> buffers[frame_trace_max_threads];
+    std::atomic<int> buffer_count;
+    std::atomic<int> generation; //bumped by init and shutdown, so threads drop buffers cached from an earlier session
+} frame_trace_info;
+
+static thread_local FrameTraceThreadBuffer* frame_trace_thread_buffer;
+static thread_local int frame_trace_thread_generation;
+
+void FrameTraceInit(int events_per_thread) {
+    //a second init would otherwise drop the old ring pointers on the floor, shutdown frees them and moves the generation on
+    FrameTraceShutdown();
+    frame_trace_info.start_time = SDL_GetPerformanceCounter();
+    frame_trace_info.clocks_per_second = SDL_GetPerformanceFrequency();
+    frame_trace_info.events_per_thread = events_per_thread;
+}
+
+//other threads must have stopped recording by now, anything they record afterwards is dropped
+void FrameTraceShutdown() {
+    frame_trace_info.events_per_thread = 0;
+    frame_trace_info.generation++;
+    int count = frame_trace_info.buffer_count.exchange(0);
+    for(int i = 0; i < count; i++) {
+        FrameTraceThreadBuffer* buffer = frame_trace_info.buffers[i].exchange(NULL);
+        if(!buffer) continue;
+        free(buffer->events);
+        free(buffer);
+    }
+    frame_trace_thread_buffer = NULL;
+}
+
+//the calling threads buffer, NULL if it was registered before the last init / shutdown (its memory is gone)
+static FrameTraceThreadBuffer* current_thread_buffer() {
+    if(frame_trace_thread_generation != frame_trace_info.generation.load(std::memory_order_relaxed)) frame_trace_thread_buffer = NULL;
+    return frame_trace_thread_buffer;
+}
+
+//the only allocation, done once the first time a thread records anything
+static FrameTraceThreadBuffer* get_thread_buffer() {
+    if(current_thread_buffer()) return frame_trace_thread_buffer;
+    if(frame_trace_info.events_per_thread <= 0) return NULL;
+
+    int index = frame_trace_info.buffer_count.load();
+    if(index >= frame_trace_max_threads) return NULL;
+
+    FrameTraceThreadBuffer* buffer = (FrameTraceThreadBuffer*)malloc(sizeof(FrameTraceThreadBuffer));
+    memset(buffer, 0, sizeof(FrameTraceThreadBuffer));
+    buffer->events = (FrameTraceEvent*)malloc(sizeof(FrameTraceEvent) * frame_trace_info.events_per_thread);
+
+    //claim a slot, another thread might have registered in the meantime
+    while(!frame_trace_info.buffer_count.compare_exchange_weak(index, index+1)) {
+        if(index >= frame_trace_max_threads) {
+            free(buffer->events);
+            free(buffer);
+            return NULL;
+        }
+    }
+    frame_trace_info.buffers[index].store(buffer, std::memory_order_release);
+    frame_trace_thread_buffer = buffer;
+    frame_trace_thread_generation = frame_trace_info.generation.load(std::memory_order_relaxed);
+    return buffer;
+}
+
+static void push_event(FrameTraceThreadBuffer* buffer, const char* name, int64_t start, int64_t end) {
+    FrameTraceEvent* event = &buffer->events[buffer->write_index % frame_trace_info.events_per_thread];
+    event->name = name;
+    event->start = start;
+    event->end = end;
+    buffer->write_index++;
+}
+
+void FrameTraceBeginZone(const char* name) {
+    FrameTraceThreadBuffer* buffer = get_thread_buffer();
+    if(!buffer) return;
+
+    //zones nested deeper than the stack are still counted so begin/end stay paired, they just dont get recorded
+    if(buffer->zone_depth < buffer->max_zone_depth) {
+        buffer->zone_names[buffer->zone_depth] = name;
+        buffer->zone_starts[buffer->zone_depth] = SDL_GetPerformanceCounter();
+    }
+    buffer->zone_depth++;
+}
+
+void FrameTraceEndZone() {
+    FrameTraceThreadBuffer* buffer = current_thread_buffer();
+    if(!buffer || buffer->zone_depth == 0) return;
+
+    buffer->zone_depth--;
+    if(buffer->zone_depth < buffer->max_zone_depth) {
+        push_event(buffer, buffer->zone_names[buffer->zone_depth], buffer->zone_starts[buffer->zone_depth], SDL_GetPerformanceCounter());
+    }
+}
+
+void FrameTraceMarker(const char* track, int64_t timestamp) {
+    FrameTraceThreadBuffer* buffer = get_thread_buffer();
+    if(!buffer) return;
+
+    push_event(buffer, track, timestamp, -1);
+}
+
+static double to_microseconds(int64_t time) {
+    return (double)(time - frame_trace_info.start_time) * 1000000.0 / frame_trace_info.clocks_per_second;
+}
+
+bool FrameTraceWriteChromeJSON(const char* path) {
+    FILE* file = fopen(path, "wb");
+    if(!file) return false;
+
+    //marker tracks get their own fake thread ids after the real threads, looked up by name pointer
+    static const int max_tracks = 16;
+    const char* tracks[max_tracks];
+    int track_count = 0;
+
+    fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+
+    int buffer_count = frame_trace_info.buffer_count.load();
+    for(int b = 0; b < buffer_count; b++) {
+        FrameTraceThreadBuffer* buffer = frame_trace_info.buffers[b].load(std::memory_order_acquire);
+        if(!buffer) continue; //slot claimed by a thread that is still setting it up
+
+        fprintf(file, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", first?"":",\n", b, b == 0?"frame thread":"worker");
+        first = false;
+
+        int64_t end = buffer->write_index;
+        int64_t begin = end - frame_trace_info.events_per_thread;
+        if(begin < 0) begin = 0;
+
+        for(int64_t i = begin; i < end; i++) {
+            FrameTraceEvent event = buffer->events[i % frame_trace_info.events_per_thread];
+
+            if(event.end >= 0) {
+                fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                    event.name, b, to_microseconds(event.start), to_microseconds(event.end) - to_microseconds(event.start));
+                continue;
+            }
+
+            int track = 0;
+            while(track < track_count && tracks[track] != event.name) track++;
+            if(track == track_count) {
+                if(track_count == max_tracks) continue;
+                tracks[track_count++] = event.name;
+                fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", frame_trace_max_threads + track, event.name);
+            }
+            fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,\"tid\":%d,\"ts\":%.3f}",
+                event.name, frame_trace_max_threads + track, to_microseconds(event.start));
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+    return fclose(file) == 0;
+}
@@ -0,0 +1,28 @@
+#include <SDL3/SDL.h>
+
+//lightweight scoped-zone instrumentation for the frame loop
+//every thread records into its own pre-allocated ring buffer, so recording a zone never allocates or takes a lock
+//the rings only keep the most recent events, which is what you want when someone reports "it stuttered a moment ago"
+//the export is chrome trace json (chrome://tracing), which https://ui.perfetto.dev also opens directly
+
+void FrameTraceInit(int events_per_thread); //calling it again starts over, the buffers of the previous session are freed like in shutdown
+void FrameTraceShutdown();
+
+//zone names and marker track names are stored by pointer, so pass string literals
+void FrameTraceBeginZone(const char* name);
+void FrameTraceEndZone();
+
+//instant event on its own track (vblank, present...), timestamp is in SDL_GetPerformanceCounter units
+void FrameTraceMarker(const char* track, int64_t timestamp);
+
+//call this from the frame thread, other threads keep recording while the file is written so their newest events may be cut off
+bool FrameTraceWriteChromeJSON(const char* path);
+
+struct FrameTraceZone {
+    FrameTraceZone(const char* name) { FrameTraceBeginZone(name); }
+    ~FrameTraceZone() { FrameTraceEndZone(); }
+};
+
+#define FRAME_TRACE_CONCAT_INNER(a, b) a##b
+#define FRAME_TRACE_CONCAT(a, b) FRAME_TRACE_CONCAT_INNER(a, b)
+#define FRAME_TRACE_ZONE(name) FrameTraceZone FRAME_TRACE_CONCAT(frame_trace_zone_, __LINE__)(name)
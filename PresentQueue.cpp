@@ -0,0 +1,132 @@
+#include "PresentQueue.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include "Windows.h"
+
+struct PresentQueue {
+    static const int max_capacity = 8;
+    PresentQueueFrame frames[max_capacity];
+    int capacity;
+
+    //monotonic counters, the slot is counter % capacity
+    std::atomic<Uint64> submitted; //written by the main thread
+    std::atomic<Uint64> presented; //written by the present thread
+
+    //only used to sleep, the ring itself doesnt need them
+    HANDLE queued_frames; //counts frames waiting for the present thread
+    HANDLE free_slots; //counts room left for the main thread
+    HANDLE frame_presented; //auto-reset, set after every present so a drain can sleep until presented catches up
+
+    //seqlock, odd while the present thread is writing
+    std::atomic<Uint32> timings_sequence;
+    PresentQueueTimings timings;
+
+    PresentQueueCallback present;
+    void* user_data;
+    std::thread thread;
+};
+
+static void publish_timings(PresentQueue* queue, const PresentQueueTimings* timings) {
+    Uint32 sequence = queue->timings_sequence.load(std::memory_order_relaxed);
+    queue->timings_sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    queue->timings = *timings;
+    queue->timings_sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void PresentQueueReadTimings(PresentQueue* queue, PresentQueueTimings* timings) {
+    while(true) {
+        Uint32 before = queue->timings_sequence.load(std::memory_order_acquire);
+        if(before & 1) continue; //present thread is mid-write, it only copies a few words so just spin
+        *timings = queue->timings;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(queue->timings_sequence.load(std::memory_order_relaxed) == before) return;
+    }
+}
+
+static void present_thread(PresentQueue* queue) {
+    PresentQueueTimings timings;
+    memset(&timings, 0, sizeof(timings));
+
+    while(true) {
+        WaitForSingleObject(queue->queued_frames, INFINITE);
+
+        Uint64 index = queue->presented.load(std::memory_order_relaxed);
+        PresentQueueFrame frame = queue->frames[index % queue->capacity];
+        if(frame.slot < 0) break; //shutdown
+
+        queue->present(&frame, &timings, queue->user_data);
+        timings.frames_presented = index + 1;
+        publish_timings(queue, &timings);
+
+        queue->presented.store(index + 1, std::memory_order_release);
+        ReleaseSemaphore(queue->free_slots, 1, NULL);
+        SetEvent(queue->frame_presented);
+    }
+}
+
+PresentQueue* CreatePresentQueue(int capacity, PresentQueueCallback present, void* user_data) {
+    if(capacity < 1) capacity = 1;
+    if(capacity > PresentQueue::max_capacity) capacity = PresentQueue::max_capacity;
+
+    PresentQueue* queue = new PresentQueue();
+    queue->capacity = capacity;
+    queue->submitted = 0;
+    queue->presented = 0;
+    queue->timings_sequence = 0;
+    memset(&queue->timings, 0, sizeof(queue->timings));
+    queue->present = present;
+    queue->user_data = user_data;
+    queue->queued_frames = CreateSemaphoreA(NULL, 0, capacity, NULL);
+    queue->free_slots = CreateSemaphoreA(NULL, capacity, capacity, NULL);
+    queue->frame_presented = CreateEventA(NULL, FALSE, FALSE, NULL);
+    queue->thread = std::thread(present_thread, queue);
+    return queue;
+}
+
+static void push_frame(PresentQueue* queue, const PresentQueueFrame* frame) {
+    WaitForSingleObject(queue->free_slots, INFINITE);
+    Uint64 index = queue->submitted.load(std::memory_order_relaxed);
+    queue->frames[index % queue->capacity] = *frame;
+    queue->submitted.store(index + 1, std::memory_order_release);
+    ReleaseSemaphore(queue->queued_frames, 1, NULL);
+}
+
+void DestroyPresentQueue(PresentQueue* queue) {
+    if(!queue) return;
+    PresentQueueFrame stop = { -1, 0 };
+    push_frame(queue, &stop);
+    queue->thread.join();
+
+    CloseHandle(queue->queued_frames);
+    CloseHandle(queue->free_slots);
+    CloseHandle(queue->frame_presented);
+    delete queue;
+}
+
+int64_t PresentQueueSubmit(PresentQueue* queue, const PresentQueueFrame* frame) {
+    Uint64 start = SDL_GetPerformanceCounter();
+    push_frame(queue, frame);
+    return SDL_GetPerformanceCounter() - start;
+}
+
+void PresentQueueDrain(PresentQueue* queue) {
+    Uint64 submitted = queue->submitted.load(std::memory_order_relaxed);
+    //the event can still be set from a present nobody waited for, that just costs one more check of presented
+    while(queue->presented.load(std::memory_order_acquire) < submitted) {
+        WaitForSingleObject(queue->frame_presented, INFINITE);
+    }
+}
+
+//the present thread is idle after a drain and picks the sequence back up from here on its next frame, so there is still only one writer at a time
+void PresentQueuePublishTimings(PresentQueue* queue, const PresentQueueTimings* timings) {
+    PresentQueueTimings replaced = *timings;
+    replaced.frames_presented = queue->presented.load(std::memory_order_relaxed);
+    publish_timings(queue, &replaced);
+}
+
+int PresentQueueCapacity(PresentQueue* queue) {
+    return queue->capacity;
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <SDL3/SDL.h>
+
+//hands finished frames from the main thread to a dedicated present thread, so the main thread keeps polling events and simulating
+//while the driver blocks in present. the frame queue is a bounded single producer / single consumer ring, the main thread only
+//blocks when it is full (that is the back-pressure that keeps it from running away from the display)
+//timings measured on the present thread come back through a seqlock, so reading them never takes a lock or waits on the present thread
+//the actual present is a callback, the DXGI adapter plugs in here but so can a fake backend that just sleeps and makes up timestamps
+
+struct PresentQueueFrame {
+    int slot; //which render target to present, meaning is up to the callback
+    int sync_interval;
+};
+
+struct PresentQueueTimings {
+    int64_t present_timestamp; //SDL_GetPerformanceCounter units, what the pacer should use as this frames time
+    int64_t sync_time;
+    unsigned int present_count;
+    unsigned int present_refresh_count;
+    unsigned int sync_refresh_count;
+    int64_t present_block_time; //time the present thread spent blocked in the last present + latency wait
+    int64_t wait_block_time;
+    int64_t timing_method_delta;
+    bool vsynced;
+    Uint64 missed_presents;
+    Uint64 frames_presented; //filled in by the queue
+};
+
+//runs on the present thread, fills in timings for the frame it just presented
+typedef void(*PresentQueueCallback)(const PresentQueueFrame* frame, PresentQueueTimings* timings, void* user_data);
+
+struct PresentQueue;
+
+PresentQueue* CreatePresentQueue(int capacity, PresentQueueCallback present, void* user_data); //capacity is clamped to 1..8
+void DestroyPresentQueue(PresentQueue* queue); //presents whatever is queued, then joins the thread
+
+//main thread only
+int64_t PresentQueueSubmit(PresentQueue* queue, const PresentQueueFrame* frame); //returns how long it blocked on a full queue, in clocks
+void PresentQueueDrain(PresentQueue* queue); //waits until every submitted frame was presented, use before touching anything the callback uses
+void PresentQueuePublishTimings(PresentQueue* queue, const PresentQueueTimings* timings); //after a drain only, replaces the snapshot when state behind it was reset
+int PresentQueueCapacity(PresentQueue* queue);
+
+//any thread, never blocks
+void PresentQueueReadTimings(PresentQueue* queue, PresentQueueTimings* timings);
@@ -0,0 +1,228 @@
+#include "QuadBatch.h"
+#include <SDL3/SDL_opengl.h>
+#include <cstdlib>
+#include <cstring>
+
+void QuadBatchInit(QuadBatch* batch, int capacity) {
+    memset(batch, 0, sizeof(QuadBatch));
+    batch->x = (float*)malloc(sizeof(float) * capacity);
+    batch->y = (float*)malloc(sizeof(float) * capacity);
+    batch->w = (float*)malloc(sizeof(float) * capacity);
+    batch->h = (float*)malloc(sizeof(float) * capacity);
+    batch->color = (Uint32*)malloc(sizeof(Uint32) * capacity);
+    batch->capacity = capacity;
+}
+
+void QuadBatchFree(QuadBatch* batch) {
+    free(batch->x);
+    free(batch->y);
+    free(batch->w);
+    free(batch->h);
+    free(batch->color);
+    memset(batch, 0, sizeof(QuadBatch));
+}
+
+void QuadBatchClear(QuadBatch* batch) {
+    batch->count = 0;
+}
+
+bool QuadBatchPush(QuadBatch* batch, float x, float y, float w, float h, Uint32 color) {
+    if(batch->count >= batch->capacity) return false;
+    int i = batch->count++;
+    batch->x[i] = x;
+    batch->y[i] = y;
+    batch->w[i] = w;
+    batch->h[i] = h;
+    batch->color[i] = color;
+    return true;
+}
+
+static Uint32 to_byte(float v) {
+    if(v < 0) v = 0;
+    if(v > 1) v = 1;
+    return (Uint32)(v * 255.0f + .5f);
+}
+
+Uint32 QuadBatchColor(float r, float g, float b, float a) {
+    return to_byte(r) | (to_byte(g) << 8) | (to_byte(b) << 16) | (to_byte(a) << 24);
+}
+
+void QuadBatchWriteVertices(const QuadBatch* batch, int first, int count, float* positions, Uint32* colors) {
+    const float* x = batch->x + first;
+    const float* y = batch->y + first;
+    const float* w = batch->w + first;
+    const float* h = batch->h + first;
+    const Uint32* color = batch->color + first;
+
+    for(int i = 0; i < count; i++) {
+        float x0 = x[i], y0 = y[i];
+        float x1 = x0 + w[i], y1 = y0 + h[i];
+        float* p = positions + i*8;
+        p[0] = x0; p[1] = y0;
+        p[2] = x1; p[3] = y0;
+        p[4] = x1; p[5] = y1;
+        p[6] = x0; p[7] = y1;
+    }
+    for(int i = 0; i < count; i++) {
+        Uint32* c = colors + i*4;
+        c[0] = c[1] = c[2] = c[3] = color[i];
+    }
+}
+
+static PFNGLGENBUFFERSPROC glGenBuffers_ptr;
+static PFNGLDELETEBUFFERSPROC glDeleteBuffers_ptr;
+static PFNGLBINDBUFFERPROC glBindBuffer_ptr;
+static PFNGLBUFFERDATAPROC glBufferData_ptr;
+static PFNGLBUFFERSTORAGEPROC glBufferStorage_ptr;
+static PFNGLMAPBUFFERRANGEPROC glMapBufferRange_ptr;
+static PFNGLUNMAPBUFFERPROC glUnmapBuffer_ptr;
+static PFNGLFENCESYNCPROC glFenceSync_ptr;
+static PFNGLCLIENTWAITSYNCPROC glClientWaitSync_ptr;
+static PFNGLDELETESYNCPROC glDeleteSync_ptr;
+
+//the persistent buffer is split into regions, one per flush in flight. a region is only rewritten once the fence placed after its draw has passed
+static const int quad_batch_region_count = 3;
+
+struct QuadBatchRenderer {
+    GLuint buffer;
+    bool persistent;
+    int quads_per_flush;
+
+    //bytes per region, positions first then colors
+    GLsizeiptr region_size;
+    GLsizeiptr color_offset;
+
+    char* mapped; //persistent only
+    GLsync fences[quad_batch_region_count];
+    int region;
+};
+
+static GLsizeiptr quad_positions_size(int quads) {
+    return (GLsizeiptr)quads * 8 * sizeof(float);
+}
+static GLsizeiptr quad_colors_size(int quads) {
+    return (GLsizeiptr)quads * 4 * sizeof(Uint32);
+}
+
+QuadBatchRenderer* CreateQuadBatchRenderer(int quads_per_flush) {
+    glGenBuffers_ptr = (PFNGLGENBUFFERSPROC)SDL_GL_GetProcAddress("glGenBuffers");
+    glDeleteBuffers_ptr = (PFNGLDELETEBUFFERSPROC)SDL_GL_GetProcAddress("glDeleteBuffers");
+    glBindBuffer_ptr = (PFNGLBINDBUFFERPROC)SDL_GL_GetProcAddress("glBindBuffer");
+    glBufferData_ptr = (PFNGLBUFFERDATAPROC)SDL_GL_GetProcAddress("glBufferData");
+    glBufferStorage_ptr = (PFNGLBUFFERSTORAGEPROC)SDL_GL_GetProcAddress("glBufferStorage");
+    glMapBufferRange_ptr = (PFNGLMAPBUFFERRANGEPROC)SDL_GL_GetProcAddress("glMapBufferRange");
+    glUnmapBuffer_ptr = (PFNGLUNMAPBUFFERPROC)SDL_GL_GetProcAddress("glUnmapBuffer");
+    glFenceSync_ptr = (PFNGLFENCESYNCPROC)SDL_GL_GetProcAddress("glFenceSync");
+    glClientWaitSync_ptr = (PFNGLCLIENTWAITSYNCPROC)SDL_GL_GetProcAddress("glClientWaitSync");
+    glDeleteSync_ptr = (PFNGLDELETESYNCPROC)SDL_GL_GetProcAddress("glDeleteSync");
+    if(!glGenBuffers_ptr || !glDeleteBuffers_ptr || !glBindBuffer_ptr || !glBufferData_ptr || !glMapBufferRange_ptr || !glUnmapBuffer_ptr) return NULL;
+
+    QuadBatchRenderer* renderer = (QuadBatchRenderer*)malloc(sizeof(QuadBatchRenderer));
+    memset(renderer, 0, sizeof(QuadBatchRenderer));
+    renderer->quads_per_flush = quads_per_flush;
+    renderer->color_offset = quad_positions_size(quads_per_flush);
+    renderer->region_size = renderer->color_offset + quad_colors_size(quads_per_flush);
+
+    glGenBuffers_ptr(1, &renderer->buffer);
+    glBindBuffer_ptr(GL_ARRAY_BUFFER, renderer->buffer);
+
+    //GL 4.4 / ARB_buffer_storage, map once and keep writing into it
+    if(glBufferStorage_ptr && glFenceSync_ptr && glClientWaitSync_ptr && glDeleteSync_ptr) {
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        GLsizeiptr size = renderer->region_size * quad_batch_region_count;
+        glBufferStorage_ptr(GL_ARRAY_BUFFER, size, NULL, flags);
+        renderer->mapped = (char*)glMapBufferRange_ptr(GL_ARRAY_BUFFER, 0, size, flags);
+        renderer->persistent = renderer->mapped != NULL;
+    }
+    if(!renderer->persistent) {
+        //cant respecify immutable storage, start over with a fresh name
+        glDeleteBuffers_ptr(1, &renderer->buffer);
+        glGenBuffers_ptr(1, &renderer->buffer);
+        glBindBuffer_ptr(GL_ARRAY_BUFFER, renderer->buffer);
+        glBufferData_ptr(GL_ARRAY_BUFFER, renderer->region_size, NULL, GL_STREAM_DRAW);
+    }
+    glBindBuffer_ptr(GL_ARRAY_BUFFER, 0);
+    return renderer;
+}
+
+void DestroyQuadBatchRenderer(QuadBatchRenderer* renderer) {
+    if(!renderer) return;
+    for(int i = 0; i < quad_batch_region_count; i++) {
+        if(renderer->fences[i]) glDeleteSync_ptr(renderer->fences[i]);
+    }
+    if(renderer->persistent) {
+        glBindBuffer_ptr(GL_ARRAY_BUFFER, renderer->buffer);
+        glUnmapBuffer_ptr(GL_ARRAY_BUFFER);
+        glBindBuffer_ptr(GL_ARRAY_BUFFER, 0);
+    }
+    glDeleteBuffers_ptr(1, &renderer->buffer);
+    free(renderer);
+}
+
+bool QuadBatchRendererIsPersistent(QuadBatchRenderer* renderer) {
+    return renderer && renderer->persistent;
+}
+
+//returns where to write this chunk, blocks only if the gpu is still reading the region from quad_batch_region_count flushes ago
+static char* acquire_region(QuadBatchRenderer* renderer, GLintptr* offset) {
+    if(!renderer->persistent) {
+        //orphan the old storage so the driver can hand us fresh memory without waiting on the previous draw
+        glBufferData_ptr(GL_ARRAY_BUFFER, renderer->region_size, NULL, GL_STREAM_DRAW);
+        *offset = 0;
+        return (char*)glMapBufferRange_ptr(GL_ARRAY_BUFFER, 0, renderer->region_size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    }
+
+    GLsync fence = renderer->fences[renderer->region];
+    if(fence) {
+        GLenum result = glClientWaitSync_ptr(fence, 0, 0);
+        while(result == GL_TIMEOUT_EXPIRED) {
+            result = glClientWaitSync_ptr(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); //1ms
+        }
+        glDeleteSync_ptr(fence);
+        renderer->fences[renderer->region] = NULL;
+    }
+    *offset = renderer->region_size * renderer->region;
+    return renderer->mapped + *offset;
+}
+
+//call after the draw that reads the region
+static void release_region(QuadBatchRenderer* renderer) {
+    if(!renderer->persistent) return;
+    renderer->fences[renderer->region] = glFenceSync_ptr(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    renderer->region = (renderer->region + 1) % quad_batch_region_count;
+}
+
+void QuadBatchRendererFlush(QuadBatchRenderer* renderer, QuadBatch* batch) {
+    if(!renderer || batch->count == 0) {
+        QuadBatchClear(batch);
+        return;
+    }
+
+    glBindBuffer_ptr(GL_ARRAY_BUFFER, renderer->buffer);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+
+    for(int first = 0; first < batch->count; first += renderer->quads_per_flush) {
+        int count = batch->count - first;
+        if(count > renderer->quads_per_flush) count = renderer->quads_per_flush;
+
+        GLintptr offset;
+        char* region = acquire_region(renderer, &offset);
+        if(!region) break;
+        QuadBatchWriteVertices(batch, first, count, (float*)region, (Uint32*)(region + renderer->color_offset));
+
+        //unmap (orphaning path) has to happen before the draw reads the buffer
+        if(!renderer->persistent) glUnmapBuffer_ptr(GL_ARRAY_BUFFER);
+
+        glVertexPointer(2, GL_FLOAT, 0, (const void*)offset);
+        glColorPointer(4, GL_UNSIGNED_BYTE, 0, (const void*)(offset + renderer->color_offset));
+        glDrawArrays(GL_QUADS, 0, count * 4);
+
+        release_region(renderer);
+    }
+
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    glBindBuffer_ptr(GL_ARRAY_BUFFER, 0);
+    QuadBatchClear(batch);
+}
@@ -0,0 +1,38 @@
+#pragma once
+#include <SDL3/SDL.h>
+
+//batched colored rectangles, replaces a glBegin/glEnd pair per rect with one draw per flush
+//split in two halves: QuadBatch is plain memory and never touches GL, so it can be filled, inspected and timed without a context,
+//QuadBatchRenderer streams a batch into a persistently mapped vertex buffer and draws it
+
+//rects are stored structure-of-arrays, expanding them to vertices is a straight loop over each array
+struct QuadBatch {
+    float* x;
+    float* y;
+    float* w;
+    float* h;
+    Uint32* color; //RGBA8, r in the lowest byte (matches GL_UNSIGNED_BYTE color arrays on little endian)
+    int count;
+    int capacity;
+};
+
+void QuadBatchInit(QuadBatch* batch, int capacity);
+void QuadBatchFree(QuadBatch* batch);
+void QuadBatchClear(QuadBatch* batch);
+bool QuadBatchPush(QuadBatch* batch, float x, float y, float w, float h, Uint32 color); //false when full, the rect is dropped
+Uint32 QuadBatchColor(float r, float g, float b, float a);
+
+//writes 4 vertices per rect (GL_QUADS winding, same as the old draw_gl_rect) for rects [first, first+count)
+//positions gets 8 floats per rect, colors gets 4 per rect
+void QuadBatchWriteVertices(const QuadBatch* batch, int first, int count, float* positions, Uint32* colors);
+
+struct QuadBatchRenderer;
+
+//needs a current GL context, uses a persistent mapped buffer with fences when glBufferStorage is available and falls back to orphaning
+QuadBatchRenderer* CreateQuadBatchRenderer(int quads_per_flush);
+void DestroyQuadBatchRenderer(QuadBatchRenderer* renderer);
+
+//draws everything in the batch with the current fixed function state and clears it
+//batches bigger than quads_per_flush are drawn in several chunks
+void QuadBatchRendererFlush(QuadBatchRenderer* renderer, QuadBatch* batch);
+bool QuadBatchRendererIsPersistent(QuadBatchRenderer* renderer);
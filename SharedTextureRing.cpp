@@ -0,0 +1,20 @@
+#include "SharedTextureRing.h"
+
+void SharedTextureRingInit(SharedTextureRing* ring, int count) {
+    if(count < 1) count = 1;
+    if(count > ring->max_slots) count = ring->max_slots;
+    ring->count = count;
+    ring->render_slot = 0;
+    ring->present_slot = -1;
+}
+
+//the slot after the one most recently submitted, so its copy can still be in flight
+int SharedTextureRingAcquire(SharedTextureRing* ring) {
+    ring->render_slot = (ring->present_slot + 1) % ring->count;
+    return ring->render_slot;
+}
+
+int SharedTextureRingSubmit(SharedTextureRing* ring) {
+    ring->present_slot = ring->render_slot;
+    return ring->present_slot;
+}
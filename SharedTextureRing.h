@@ -0,0 +1,15 @@
+#pragma once
+
+//ring of GL-shared color textures for the DXGI adapter. GL renders into one slot while the copy of the previous slot into the backbuffer
+//is still running on the gpu, so locking the next frame never has to wait for that copy
+//just the slot bookkeeping, the textures themselves live in the adapter, indexed by slot
+struct SharedTextureRing {
+    static const int max_slots = 4;
+    int count;
+    int render_slot; //slot GL renders into this frame
+    int present_slot; //slot most recently handed to the copy, -1 before the first present
+};
+
+void SharedTextureRingInit(SharedTextureRing* ring, int count); //count is clamped to 1..max_slots, 1 means rendering waits for every copy
+int SharedTextureRingAcquire(SharedTextureRing* ring); //next slot to render into, the one after the last submitted. acquiring again without a submit gives the same slot
+int SharedTextureRingSubmit(SharedTextureRing* ring); //hands the slot GL just finished to the copy, returns it
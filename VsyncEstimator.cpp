@@ -0,0 +1,152 @@
+#include "VsyncEstimator.h"
+#include <cmath>
+#include <cstring>
+
+VsyncEstimatorConfig VsyncEstimatorDefaultConfig() {
+    VsyncEstimatorConfig config;
+    memset(&config, 0, sizeof(config));
+    config.update = VsyncEstimatorHysteresis;
+
+    config.frames_to_lose_sync = 4;
+    config.frames_to_gain_sync = 16;
+    config.threshold = .005; //5ms range for vsync detection (dont know if theres a better way to determine a threshold here, 5ms seems like enough to absorb one-frame measurement error)
+    config.warmup_threshold = .1; //if we havent recorded enough frames, 100ms error range instead (this should diverge fast if not actually vsynced, so we dont have to wait too long)
+    config.warmup_frames = 128;
+    config.window = 128;
+    config.history = 1024; //~17s at 60hz, long enough that a period error of a few microseconds adds up to something measurable
+    config.max_refresh_error = .002;
+
+    config.residual_window = 16;
+    config.max_residual_deviation = .15; //uniformly distributed residuals (not vsynced) have a deviation of ~.29 periods
+
+    config.hit_threshold = .1;
+    config.synced_hit_rate = .95;
+    config.false_positive_rate = .01;
+    config.false_negative_rate = .01;
+    return config;
+}
+
+VsyncEstimatorConfig VsyncEstimatorDefaultConfigDXGI() {
+    VsyncEstimatorConfig config = VsyncEstimatorDefaultConfig();
+    config.frames_to_lose_sync = 4;
+    config.frames_to_gain_sync = 8;
+    config.threshold = .0001; //DXGI timestamps are much more precise, 0.1ms per refresh that passed
+    config.warmup_frames = 0;
+    return config;
+}
+
+void VsyncEstimatorInit(VsyncEstimator* estimator, const VsyncEstimatorConfig* config, bool initial_guess) {
+    memset(estimator, 0, sizeof(VsyncEstimator));
+    VsyncEstimatorSetConfig(estimator, config);
+    estimator->is_vsynced = initial_guess;
+}
+
+void VsyncEstimatorSetConfig(VsyncEstimator* estimator, const VsyncEstimatorConfig* config) {
+    estimator->config = *config;
+    if(!estimator->config.update) estimator->config.update = VsyncEstimatorHysteresis;
+    if(estimator->config.residual_window > estimator->max_residual_window) estimator->config.residual_window = estimator->max_residual_window;
+    if(estimator->config.residual_window < 2) estimator->config.residual_window = 2;
+
+    estimator->counter = 0;
+    estimator->residual_count = 0;
+    estimator->residual_index = 0;
+    estimator->log_likelihood_ratio = 0;
+}
+
+void VsyncEstimatorReset(VsyncEstimator* estimator, bool vsynced) {
+    estimator->is_vsynced = vsynced;
+    estimator->counter = 0;
+    estimator->frames = 0;
+    estimator->residual_count = 0;
+    estimator->residual_index = 0;
+    estimator->log_likelihood_ratio = 0;
+}
+
+bool VsyncEstimatorUpdate(VsyncEstimator* estimator, const VsyncEstimatorSample* sample) {
+    estimator->frames++;
+    estimator->is_vsynced = estimator->config.update(estimator, sample);
+    return estimator->is_vsynced;
+}
+
+bool VsyncEstimatorHysteresis(VsyncEstimator* estimator, const VsyncEstimatorSample* sample) {
+    const VsyncEstimatorConfig* config = &estimator->config;
+
+    double threshold = config->threshold;
+    if(estimator->frames < config->warmup_frames) threshold = config->warmup_threshold;
+    bool probably_vsynced = fabs(sample->error) < threshold * sample->tolerance_scale;
+
+    //because of random spikes the error can be "off" sometimes, but usually resolved on the next frame.
+    //we wanna make sure we detect "not vsynced" for a few frames in a row before deciding thats the case
+    if(estimator->is_vsynced) {
+        estimator->counter += probably_vsynced?-1:1;
+        if(estimator->counter < 0) estimator->counter = 0;
+        if(estimator->counter >= config->frames_to_lose_sync) { //net +N unsynced frames, we aren't vsynced
+            estimator->counter = 0;
+            return false;
+        }
+    } else {
+        estimator->counter += probably_vsynced?1:-1;
+        if(estimator->counter < 0 || sample->definitely_not_vsynced) estimator->counter = 0;
+        if(estimator->counter >= config->frames_to_gain_sync) { //net +N vsynced frames, we are probably vsynced
+            estimator->counter = 0;
+            return true;
+        }
+    }
+    return estimator->is_vsynced;
+}
+
+bool VsyncEstimatorResidualVariance(VsyncEstimator* estimator, const VsyncEstimatorSample* sample) {
+    const VsyncEstimatorConfig* config = &estimator->config;
+    if(sample->refresh_period <= 0) return estimator->is_vsynced;
+
+    if(sample->definitely_not_vsynced) {
+        estimator->residual_count = 0;
+        return false;
+    }
+
+    //residuals are normalized to the refresh period so the threshold works at any refresh rate
+    estimator->residuals[estimator->residual_index] = sample->residual / sample->refresh_period;
+    estimator->residual_index = (estimator->residual_index + 1) % config->residual_window;
+    if(estimator->residual_count < config->residual_window) estimator->residual_count++;
+
+    //wait for a few samples before trusting the spread at all
+    if(estimator->residual_count < config->residual_window / 2) return estimator->is_vsynced;
+
+    //spread about zero (the refresh itself), not about the mean: a steady cadence off the grid (uncapped at more than twice the refresh rate
+    //always lands within half a refresh, every frame the same distance away) has no variance at all, but is as far from vsynced as it gets
+    double sum_sq = 0;
+    for(int i = 0; i < estimator->residual_count; i++) {
+        sum_sq += estimator->residuals[i] * estimator->residuals[i];
+    }
+    double deviation = sqrt(sum_sq / estimator->residual_count);
+
+    //small band between the enter and leave thresholds so we dont flip flop right at the edge
+    if(estimator->is_vsynced) return deviation < config->max_residual_deviation * 1.25;
+    return deviation < config->max_residual_deviation;
+}
+
+bool VsyncEstimatorSequentialTest(VsyncEstimator* estimator, const VsyncEstimatorSample* sample) {
+    const VsyncEstimatorConfig* config = &estimator->config;
+    if(sample->refresh_period <= 0) return estimator->is_vsynced;
+
+    //each frame is a coin flip: does it land close to a refresh? vsynced frames almost always do, unsynced ones land anywhere
+    double synced_rate = config->synced_hit_rate;
+    double unsynced_rate = 2 * config->hit_threshold;
+    bool hit = !sample->definitely_not_vsynced && fabs(sample->residual) < config->hit_threshold * sample->refresh_period;
+
+    estimator->log_likelihood_ratio += hit?log(synced_rate / unsynced_rate):log((1 - synced_rate) / (1 - unsynced_rate));
+
+    double accept_synced = log((1 - config->false_negative_rate) / config->false_positive_rate);
+    double accept_unsynced = log(config->false_negative_rate / (1 - config->false_positive_rate));
+
+    //once a bound is crossed, start a fresh test so old evidence doesnt slow down the next switch
+    if(estimator->log_likelihood_ratio >= accept_synced) {
+        estimator->log_likelihood_ratio = 0;
+        return true;
+    }
+    if(estimator->log_likelihood_ratio <= accept_unsynced) {
+        estimator->log_likelihood_ratio = 0;
+        return false;
+    }
+    return estimator->is_vsynced;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <SDL3/SDL.h>
+
+//vsync detection shared by the DXGI adapter and the non-DXGI timing path
+//every frame the timing backend measures how far the frame landed from where a vsynced frame would have landed,
+//and the estimator decides whether we are actually vsynced. the decision logic is pluggable per app, see VsyncEstimatorConfig::update
+
+struct VsyncEstimatorSample {
+    double error; //seconds, compared against the threshold by the hysteresis strategy (drift over the window without DXGI, latency error with DXGI)
+    double tolerance_scale; //multiplier for the threshold, DXGI allows more error when several refreshes passed
+    double residual; //seconds, this frames distance from the nearest refresh, used by the statistical strategies
+    double refresh_period; //seconds
+    bool definitely_not_vsynced;
+};
+
+struct VsyncEstimator;
+typedef bool(*VsyncEstimatorUpdateFunc)(VsyncEstimator* estimator, const VsyncEstimatorSample* sample);
+
+struct VsyncEstimatorConfig {
+    VsyncEstimatorUpdateFunc update;
+
+    //hysteresis strategy
+    int frames_to_lose_sync; //net unsynced frames before we decide we aren't vsynced
+    int frames_to_gain_sync; //net synced frames before we decide we are
+    double threshold; //seconds
+    double warmup_threshold; //seconds, used instead of threshold for the first warmup_frames
+    int warmup_frames;
+
+    //drift window length in frames (non-DXGI only), the drift compared against the threshold is summed over this many frames
+    int window;
+    //frames of drift kept behind it for the statistics (non-DXGI only, clamped to DriftWindow::max_length, window is clamped to this)
+    int history;
+    double max_refresh_error; //fraction of the refresh period, drift that grows steadily slower than this with no frame off the grid is the refresh rate being slightly off, not lost vsync
+
+    //residual variance strategy
+    int residual_window; //frames, clamped to VsyncEstimator::max_residual_window
+    double max_residual_deviation; //fraction of the refresh period, vsynced frames have an rms residual (about zero) below this
+
+    //sequential probability ratio strategy
+    double hit_threshold; //fraction of the refresh period, a residual below this counts as a "hit"
+    double synced_hit_rate; //how often we expect a hit when vsynced (unsynced frames land uniformly, so hit rate is 2*hit_threshold)
+    double false_positive_rate; //chance of deciding vsynced when we aren't
+    double false_negative_rate; //chance of deciding not vsynced when we are
+};
+
+struct VsyncEstimator {
+    VsyncEstimatorConfig config;
+    bool is_vsynced;
+    int counter;
+    int64_t frames;
+    double log_likelihood_ratio;
+
+    //the residual history is last so the scalars above share cache lines with each other instead of with the far end of it
+    static const int max_residual_window = 128;
+    int residual_count;
+    int residual_index;
+    double residuals[max_residual_window];
+};
+
+//the shipped strategies, assign one of these (or your own) to VsyncEstimatorConfig::update
+bool VsyncEstimatorHysteresis(VsyncEstimator* estimator, const VsyncEstimatorSample* sample); //the original heuristic, counts synced/unsynced frames
+bool VsyncEstimatorResidualVariance(VsyncEstimator* estimator, const VsyncEstimatorSample* sample); //vsynced frames have a much tighter residual spread than unsynced ones
+bool VsyncEstimatorSequentialTest(VsyncEstimator* estimator, const VsyncEstimatorSample* sample); //wald sequential probability ratio test, locks in within a few frames
+
+VsyncEstimatorConfig VsyncEstimatorDefaultConfig(); //thresholds the non-DXGI path always used
+VsyncEstimatorConfig VsyncEstimatorDefaultConfigDXGI(); //thresholds the DXGI adapter always used
+
+void VsyncEstimatorInit(VsyncEstimator* estimator, const VsyncEstimatorConfig* config, bool initial_guess);
+void VsyncEstimatorSetConfig(VsyncEstimator* estimator, const VsyncEstimatorConfig* config); //keeps the current decision, drops the collected evidence
+void VsyncEstimatorReset(VsyncEstimator* estimator, bool vsynced);
+bool VsyncEstimatorUpdate(VsyncEstimator* estimator, const VsyncEstimatorSample* sample);
@@ -0,0 +1,98 @@
+//checks for the DXGI adapter pieces that run without a device (see DXGISwapChainAdapterInternal.h)
+//  latency modes: the buffer count / frame latency each mode asks for, and that switching between any two only makes the swapchain
+//                 calls for what changed, against a mock that records them
+//
+//build:
+//  cl /std:c++17 /EHsc /O2 /I. tests\DXGISwapChainAdapterTest.cpp DXGISwapChainAdapter.cpp FrameTrace.cpp PresentQueue.cpp SharedTextureRing.cpp
+//     VsyncEstimator.cpp SDL3.lib opengl32.lib d3d11.lib dxgi.lib
+//returns non zero if anything failed
+#include <SDL3/SDL.h>
+#include "../DXGISwapChainAdapterInternal.h"
+#include <cstdio>
+
+static int failures;
+
+static void check(const char* name, const char* what, bool ok) {
+    printf("%s %-12s %s\n", ok?"ok  ":"FAIL", name, what);
+    if(!ok) failures++;
+}
+
+//records what DXGISwapChainAdapterApplyLatencyParams asked of the swapchain
+struct MockSwapChain {
+    int resize_calls;
+    unsigned int buffer_count;
+    int latency_calls;
+    unsigned int max_frame_latency;
+    HRESULT resize_result; //what ResizeBuffers returns
+};
+
+static HRESULT mock_resize_buffers(void* user_data, unsigned int buffer_count) {
+    MockSwapChain* swapchain = (MockSwapChain*)user_data;
+    swapchain->resize_calls++;
+    if(SUCCEEDED(swapchain->resize_result)) swapchain->buffer_count = buffer_count;
+    return swapchain->resize_result;
+}
+
+static HRESULT mock_set_maximum_frame_latency(void* user_data, unsigned int max_frame_latency) {
+    MockSwapChain* swapchain = (MockSwapChain*)user_data;
+    swapchain->latency_calls++;
+    swapchain->max_frame_latency = max_frame_latency;
+    return S_OK;
+}
+
+static MockSwapChain make_mock(const DXGISwapChainAdapterLatencyParams* params) {
+    MockSwapChain swapchain = {};
+    swapchain.buffer_count = params->buffer_count;
+    swapchain.max_frame_latency = params->max_frame_latency;
+    swapchain.resize_result = S_OK;
+    return swapchain;
+}
+
+static bool params_are(DXGISwapChainAdapterLatencyMode mode, unsigned int buffer_count, unsigned int max_frame_latency) {
+    DXGISwapChainAdapterLatencyParams params = DXGISwapChainAdapterGetLatencyParams(mode);
+    return params.buffer_count == buffer_count && params.max_frame_latency == max_frame_latency;
+}
+
+static void test_latency_modes() {
+    const char* name = "latency";
+    check(name, "LOW is 2 buffers, 1 frame queued", params_are(DXGI_SWAPCHAIN_LATENCY_LOW, 2, 1));
+    check(name, "BALANCED is 3 buffers, 1 frame queued", params_are(DXGI_SWAPCHAIN_LATENCY_BALANCED, 3, 1));
+    check(name, "THROUGHPUT is 3 buffers, 2 frames queued", params_are(DXGI_SWAPCHAIN_LATENCY_THROUGHPUT, 3, 2));
+
+    //every switch, including to the same mode
+    const DXGISwapChainAdapterLatencyMode modes[] = { DXGI_SWAPCHAIN_LATENCY_LOW, DXGI_SWAPCHAIN_LATENCY_BALANCED, DXGI_SWAPCHAIN_LATENCY_THROUGHPUT };
+    bool reached = true, resize_only_on_change = true, latency_only_on_change = true;
+    for(DXGISwapChainAdapterLatencyMode from : modes) {
+        for(DXGISwapChainAdapterLatencyMode to : modes) {
+            DXGISwapChainAdapterLatencyParams current = DXGISwapChainAdapterGetLatencyParams(from);
+            DXGISwapChainAdapterLatencyParams params = DXGISwapChainAdapterGetLatencyParams(to);
+            MockSwapChain swapchain = make_mock(&current);
+            DXGISwapChainLatencyOps ops = { mock_resize_buffers, mock_set_maximum_frame_latency, &swapchain };
+
+            HRESULT hr = DXGISwapChainAdapterApplyLatencyParams(&ops, &current, &params);
+            reached = reached && SUCCEEDED(hr) && swapchain.buffer_count == params.buffer_count && swapchain.max_frame_latency == params.max_frame_latency;
+            resize_only_on_change = resize_only_on_change && swapchain.resize_calls == (current.buffer_count != params.buffer_count?1:0);
+            latency_only_on_change = latency_only_on_change && swapchain.latency_calls == (current.max_frame_latency != params.max_frame_latency?1:0);
+        }
+    }
+    check(name, "every switch ends at the new mode", reached);
+    check(name, "ResizeBuffers only when the count changes", resize_only_on_change);
+    check(name, "SetMaximumFrameLatency only when it changes", latency_only_on_change);
+
+    //LOW to THROUGHPUT changes both, a failed resize stops there and is returned
+    DXGISwapChainAdapterLatencyParams low = DXGISwapChainAdapterGetLatencyParams(DXGI_SWAPCHAIN_LATENCY_LOW);
+    DXGISwapChainAdapterLatencyParams throughput = DXGISwapChainAdapterGetLatencyParams(DXGI_SWAPCHAIN_LATENCY_THROUGHPUT);
+    MockSwapChain swapchain = make_mock(&low);
+    swapchain.resize_result = E_FAIL;
+    DXGISwapChainLatencyOps ops = { mock_resize_buffers, mock_set_maximum_frame_latency, &swapchain };
+    HRESULT hr = DXGISwapChainAdapterApplyLatencyParams(&ops, &low, &throughput);
+    check(name, "a failed resize is returned", hr == E_FAIL);
+    check(name, "and the latency is left alone", swapchain.latency_calls == 0 && swapchain.max_frame_latency == low.max_frame_latency);
+}
+
+int main(int argc, char* argv[]) {
+    test_latency_modes();
+
+    printf(failures?"%d check(s) failed\n":"all checks passed\n", failures);
+    return failures?1:0;
+}
@@ -0,0 +1,132 @@
+//checks for DisplayProfileCache: profiles survive a save / load round trip field for field, a file from an older version or with a
+//bad header is refused without leaving stale entries behind, and a full cache replaces the least recently stored entry
+//
+//build:
+//  cl /std:c++17 /EHsc /O2 /I. tests\DisplayProfileCacheTest.cpp DisplayProfileCache.cpp SDL3.lib
+//returns non zero if anything failed, writes its scratch file to the working directory
+#include <SDL3/SDL.h>
+#include "../DisplayProfileCache.h"
+#include <cstdio>
+#include <cstring>
+
+static int failures;
+
+static void check(const char* name, const char* what, bool ok) {
+    printf("%s %-12s %s\n", ok?"ok  ":"FAIL", name, what);
+    if(!ok) failures++;
+}
+
+static const char* test_path = "display_profile_cache_test.bin";
+
+static bool same_profile(const DisplayTimingProfile* a, const DisplayTimingProfile* b) {
+    return a->refresh_period == b->refresh_period && a->present_latency == b->present_latency && a->swap_interval == b->swap_interval && a->vsynced == b->vsynced;
+}
+
+static void make_profile(DisplayTimingProfile* profile, double refresh_period, double present_latency, int swap_interval, bool vsynced) {
+    profile->refresh_period = refresh_period;
+    profile->present_latency = present_latency;
+    profile->swap_interval = swap_interval;
+    profile->vsynced = vsynced;
+}
+
+static void test_round_trip() {
+    const char* name = "round trip";
+    Uint64 key_a = DisplayProfileCacheKey("DELL U2720Q", 3840, 2160, 59.94f, 1.5f);
+    Uint64 key_b = DisplayProfileCacheKey("DELL U2720Q", 3840, 2160, 60.0f, 1.5f);
+    check(name, "a mode switch gets its own key", key_a != key_b);
+
+    DisplayProfileCacheLoad(""); //empties the cache
+    DisplayTimingProfile a, b, found;
+    make_profile(&a, 1001 / 60000.0, .0042, 1, true);
+    make_profile(&b, 1 / 60.0, .0007, 0, false);
+    DisplayProfileCacheStore(key_a, &a);
+    DisplayProfileCacheStore(key_b, &b);
+    check(name, "saves", DisplayProfileCacheSave(test_path));
+
+    DisplayProfileCacheLoad(""); //nothing left in memory, everything below comes from the file
+    check(name, "loads", DisplayProfileCacheLoad(test_path));
+    check(name, "first profile comes back unchanged", DisplayProfileCacheFind(key_a, &found) && same_profile(&found, &a));
+    check(name, "second profile comes back unchanged", DisplayProfileCacheFind(key_b, &found) && same_profile(&found, &b));
+    check(name, "unknown key isnt found", !DisplayProfileCacheFind(key_a ^ 1, &found));
+
+    //storing under an existing key replaces it instead of adding a second entry
+    make_profile(&a, 1001 / 60000.0, .0051, 2, false);
+    DisplayProfileCacheStore(key_a, &a);
+    DisplayProfileCacheSave(test_path);
+    DisplayProfileCacheLoad(test_path);
+    check(name, "storing again replaces the entry", DisplayProfileCacheFind(key_a, &found) && same_profile(&found, &a));
+}
+
+//a file with the current magic and a given version, holding one entry laid out like the current one
+static void write_file(Uint32 magic, Uint32 version, Uint32 count, Uint64 key, size_t truncate_by) {
+    Uint32 header[4] = { magic, version, count, 0 };
+    Uint8 entry[40];
+    memset(entry, 0, sizeof(entry));
+    memcpy(entry, &key, sizeof(key));
+
+    FILE* file = fopen(test_path, "wb");
+    fwrite(header, sizeof(header), 1, file);
+    fwrite(entry, sizeof(entry) - truncate_by, 1, file);
+    fclose(file);
+}
+
+static void test_rejected_files() {
+    const char* name = "rejected";
+    Uint64 key = DisplayProfileCacheKey("LG 27GN950", 3840, 2160, 144.0f, 1.0f);
+    DisplayTimingProfile profile, found;
+    make_profile(&profile, 1 / 144.0, .001, 1, true);
+
+    //a good file first, so a refused load has something to throw away
+    DisplayProfileCacheLoad("");
+    DisplayProfileCacheStore(key, &profile);
+    DisplayProfileCacheSave(test_path);
+    check(name, "current version loads", DisplayProfileCacheLoad(test_path) && DisplayProfileCacheFind(key, &found));
+
+    //version 1 entries had no swap_interval, their decision cant be matched to an interval
+    write_file(0x50435046, 1, 1, key, 0);
+    check(name, "version 1 file is refused", !DisplayProfileCacheLoad(test_path));
+    check(name, "refused file leaves nothing behind", !DisplayProfileCacheFind(key, &found));
+
+    write_file(0x12345678, 2, 1, key, 0);
+    check(name, "bad magic is refused", !DisplayProfileCacheLoad(test_path) && !DisplayProfileCacheFind(key, &found));
+    write_file(0x50435046, 2, 1, key, 8);
+    check(name, "truncated file is refused", !DisplayProfileCacheLoad(test_path) && !DisplayProfileCacheFind(key, &found));
+    write_file(0x50435046, 2, 17, key, 0);
+    check(name, "too many entries is refused", !DisplayProfileCacheLoad(test_path) && !DisplayProfileCacheFind(key, &found));
+    write_file(0x50435046, 2, 1, key, 0);
+    check(name, "same layout at version 2 loads", DisplayProfileCacheLoad(test_path) && DisplayProfileCacheFind(key, &found));
+
+    remove(test_path);
+    check(name, "missing file is refused", !DisplayProfileCacheLoad(test_path));
+}
+
+static void test_eviction() {
+    const char* name = "eviction";
+    DisplayProfileCacheLoad("");
+    DisplayTimingProfile profile, found;
+    make_profile(&profile, 1 / 60.0, 0, 1, true);
+
+    //16 entries fill the cache, then touch the first one again so the second is the least recently stored
+    for(int i = 0; i < 16; i++) DisplayProfileCacheStore(1000 + i, &profile);
+    DisplayProfileCacheStore(1000, &profile);
+    DisplayProfileCacheStore(2000, &profile);
+    check(name, "new entry is kept", DisplayProfileCacheFind(2000, &found));
+    check(name, "least recently stored is replaced", !DisplayProfileCacheFind(1001, &found));
+    check(name, "restored entry survives", DisplayProfileCacheFind(1000, &found));
+
+    //the recency order survives a save / load, the next eviction picks the next oldest
+    DisplayProfileCacheSave(test_path);
+    DisplayProfileCacheLoad(test_path);
+    DisplayProfileCacheStore(3000, &profile);
+    check(name, "order survives a reload", !DisplayProfileCacheFind(1002, &found) && DisplayProfileCacheFind(1003, &found));
+    remove(test_path);
+}
+
+int main(int argc, char* argv[]) {
+    test_round_trip();
+    test_rejected_files();
+    test_eviction();
+
+    printf(failures?"%d check(s) failed\n":"all checks passed\n", failures);
+    return failures?1:0;
+}
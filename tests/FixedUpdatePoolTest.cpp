@@ -0,0 +1,153 @@
+//checks for FixedUpdatePool: every partition runs exactly once per tick, idle workers steal from a busy one,
+//and serial / partitions / post_tick of a tick run in that order with serial and post_tick on the calling thread
+//
+//build:
+//  cl /std:c++17 /EHsc /O2 /I. tests\FixedUpdatePoolTest.cpp FixedUpdatePool.cpp FrameTrace.cpp SDL3.lib
+//returns non zero if anything failed
+#include <SDL3/SDL.h>
+#include "../FixedUpdatePool.h"
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+static int failures;
+
+static void check(const char* name, const char* what, bool ok) {
+    printf("%s %-12s %s\n", ok?"ok  ":"FAIL", name, what);
+    if(!ok) failures++;
+}
+
+static const int max_ticks = 8;
+static const int max_partitions = 64;
+
+struct PoolRecord {
+    int partition_count;
+    std::thread::id caller;
+    Uint64 slow_partition_clocks; //partition 0 spins this long, 0 = every partition is cheap
+
+    int serial_tick; //tick the last serial step started, the partitions belong to it
+    int post_ticks; //post_tick calls so far
+    std::atomic<int> runs[max_ticks][max_partitions];
+    std::atomic<bool> ran_off_caller[max_ticks][max_partitions];
+    std::atomic<int> out_of_order; //partitions that ran outside their ticks serial / post_tick window
+    int serial_off_caller;
+    int post_tick_off_caller;
+    int post_tick_early; //post_tick before every partition of its tick was done
+} pool_record;
+
+static void reset_record(int partition_count, Uint64 slow_partition_clocks) {
+    pool_record.partition_count = partition_count;
+    pool_record.caller = std::this_thread::get_id();
+    pool_record.slow_partition_clocks = slow_partition_clocks;
+    pool_record.serial_tick = -1;
+    pool_record.post_ticks = 0;
+    for(int t = 0; t < max_ticks; t++) {
+        for(int p = 0; p < max_partitions; p++) {
+            pool_record.runs[t][p] = 0;
+            pool_record.ran_off_caller[t][p] = false;
+        }
+    }
+    pool_record.out_of_order = 0;
+    pool_record.serial_off_caller = 0;
+    pool_record.post_tick_off_caller = 0;
+    pool_record.post_tick_early = 0;
+}
+
+static void serial_step(double delta_time, void* user_data) {
+    if(std::this_thread::get_id() != pool_record.caller) pool_record.serial_off_caller++;
+    pool_record.serial_tick++;
+}
+
+static void partition_step(int partition, double delta_time, void* user_data) {
+    int tick = pool_record.serial_tick;
+    //the previous ticks post_tick has run and this ticks serial has, so exactly tick post_ticks so far
+    if(tick < 0 || pool_record.post_ticks != tick) pool_record.out_of_order++;
+    if(tick >= 0 && tick < max_ticks) {
+        pool_record.runs[tick][partition]++;
+        if(std::this_thread::get_id() != pool_record.caller) pool_record.ran_off_caller[tick][partition] = true;
+    }
+
+    if(partition == 0 && pool_record.slow_partition_clocks) {
+        Uint64 until = SDL_GetPerformanceCounter() + pool_record.slow_partition_clocks;
+        while(SDL_GetPerformanceCounter() < until) std::this_thread::yield();
+    }
+}
+
+static void post_tick_step(double delta_time, void* user_data) {
+    if(std::this_thread::get_id() != pool_record.caller) pool_record.post_tick_off_caller++;
+    int tick = pool_record.serial_tick;
+    for(int p = 0; p < pool_record.partition_count; p++) {
+        if(pool_record.runs[tick][p] == 0) pool_record.post_tick_early++;
+    }
+    pool_record.post_ticks++;
+}
+
+static bool every_partition_once(int ticks) {
+    for(int t = 0; t < ticks; t++) {
+        for(int p = 0; p < pool_record.partition_count; p++) {
+            if(pool_record.runs[t][p] != 1) return false;
+        }
+    }
+    return true;
+}
+
+static void test_exactly_once() {
+    const char* name = "once";
+    FixedUpdatePool* pool = CreateFixedUpdatePool(4);
+
+    //uneven split (37 over 4 workers) and more workers than partitions
+    const int partition_counts[] = { 37, 3, 1 };
+    bool once = true, ordered = true, ticks_ok = true;
+    for(int partition_count : partition_counts) {
+        for(int run = 0; run < 50; run++) {
+            int ticks = 1 + run % max_ticks;
+            reset_record(partition_count, 0);
+            FixedUpdatePoolRun(pool, ticks, partition_count, partition_step, serial_step, post_tick_step, 1/60.0, NULL);
+            once = once && every_partition_once(ticks);
+            ordered = ordered && pool_record.out_of_order == 0 && pool_record.post_tick_early == 0;
+            ticks_ok = ticks_ok && pool_record.serial_tick == ticks - 1 && pool_record.post_ticks == ticks;
+        }
+    }
+    check(name, "every partition runs exactly once per tick", once);
+    check(name, "one serial and one post_tick per tick", ticks_ok);
+    check(name, "serial, then the partitions, then post_tick", ordered);
+    check(name, "serial and post_tick run on the caller", pool_record.serial_off_caller == 0 && pool_record.post_tick_off_caller == 0);
+
+    //no serial / post_tick is fine too
+    reset_record(16, 0);
+    pool_record.serial_tick = 0;
+    FixedUpdatePoolRun(pool, 1, 16, partition_step, NULL, NULL, 1/60.0, NULL);
+    check(name, "runs without serial or post_tick", every_partition_once(1));
+    DestroyFixedUpdatePool(pool);
+}
+
+static void test_stealing() {
+    const char* name = "stealing";
+    FixedUpdatePool* pool = CreateFixedUpdatePool(4);
+
+    //partition 0 opens the callers own range [0, 4) and takes 20ms, the other workers finish their cheap ranges and should take 1..3 off it
+    const int partition_count = 16;
+    const int ticks = 3;
+    reset_record(partition_count, SDL_GetPerformanceFrequency() / 50);
+    FixedUpdatePoolRun(pool, ticks, partition_count, partition_step, serial_step, post_tick_step, 1/60.0, NULL);
+
+    bool stolen = true;
+    for(int t = 0; t < ticks; t++) {
+        bool tick_stolen = false;
+        for(int p = 1; p < partition_count / 4; p++) tick_stolen = tick_stolen || pool_record.ran_off_caller[t][p];
+        stolen = stolen && tick_stolen;
+    }
+    check(name, "every partition still runs exactly once", every_partition_once(ticks));
+    check(name, "the busy callers range is stolen from", stolen);
+    check(name, "a slow partition doesnt break the ordering", pool_record.out_of_order == 0 && pool_record.post_tick_early == 0);
+    DestroyFixedUpdatePool(pool);
+}
+
+int main(int argc, char* argv[]) {
+    test_exactly_once();
+    test_stealing();
+
+    printf(failures?"%d check(s) failed\n":"all checks passed\n", failures);
+    return failures?1:0;
+}
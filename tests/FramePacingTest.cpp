@@ -0,0 +1,402 @@
+//scripted clock tests for the non-DXGI pacing path, no window or display needed
+//each scenario feeds a scripted sequence of swap timestamps through SDL_Internal_SwapBuffersAndMeasureTime_NonDXGI(NULL),
+//SDL_Internal_FramePacing_ComputeDeltaTime(NULL) and SDL_PaceFrame, checks the reported times against jitter, drift, tick count
+//and vsync lock time bounds, and diffs what the pacer reported every frame against a golden trace in tests/golden
+//
+//build it like the sample, with this file in place of FramePacing.cpp (it is included below, without the sample main):
+//  cl /std:c++17 /EHsc /O2 /I. tests\FramePacingTest.cpp DXGISwapChainAdapter.cpp DisplayProfileCache.cpp DriftWindow.cpp FixedUpdatePool.cpp
+//     FrameRecorder.cpp FrameTrace.cpp PresentQueue.cpp QuadBatch.cpp SharedTextureRing.cpp VsyncEstimator.cpp SDL3.lib opengl32.lib d3d11.lib dxgi.lib
+//run it from the repo root, it returns non zero if anything failed. --update rewrites the golden traces after an intended change
+//tests\build_tests.bat builds and runs this and every other test
+#define FRAME_PACING_NO_SAMPLE
+#include "../FramePacing.cpp"
+#include <cstdio>
+#include <cstdlib>
+
+static const Uint64 test_clocks_per_second = 10000000; //what QueryPerformanceCounter runs at
+static const Uint64 test_start_time = test_clocks_per_second; //the pacer treats a timestamp of 0 as "no frame yet"
+static const double test_refresh_rate = 60; //what the pacer assumes without a display
+
+struct TestClock {
+    Uint64 now;
+} test_clock;
+
+static Uint64 read_test_clock(void* user_data) {
+    return ((TestClock*)user_data)->now;
+}
+
+//xorshift, so the noise is the same on every platform and compiler
+struct TestRandom {
+    Uint64 state;
+};
+
+static double test_random(TestRandom* random) { //0..1
+    random->state ^= random->state << 13;
+    random->state ^= random->state >> 7;
+    random->state ^= random->state << 17;
+    return (random->state >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static Uint64 seconds_to_clocks(double seconds) {
+    return (Uint64)llround(seconds * test_clocks_per_second);
+}
+
+//start of refresh n, exact for the whole run
+static Uint64 vblank_time(Uint64 n) {
+    return test_start_time + n * test_clocks_per_second / (Uint64)test_refresh_rate;
+}
+
+//what the pacer reported for one frame
+struct TestFrame {
+    Uint64 swap_time; //scripted, clocks
+    Uint64 delta_time_ns;
+    Uint64 timeline_ns;
+    int ticks;
+    bool vsynced;
+};
+
+struct TestRun {
+    const char* name;
+    static const int max_frames = 2048;
+    TestFrame frames[max_frames];
+    int frame_count;
+    SDL_FramePacingInfo pacing_info;
+};
+
+static void test_update(const SDL_FramePacingContext* context, void* user_data) {
+}
+
+static void test_render(const SDL_FramePacingContext* context, void* user_data) {
+    TestRun* run = (TestRun*)user_data;
+    TestFrame* frame = &run->frames[run->frame_count - 1];
+    frame->delta_time_ns = context->delta_time_ns;
+    frame->timeline_ns = context->timeline_ns;
+    frame->ticks = context->tick_count;
+    frame->vsynced = context->vsynced;
+}
+
+static void begin_run(TestRun* run, const char* name) {
+    memset(run, 0, sizeof(TestRun));
+    run->name = name;
+    run->pacing_info.update_rate = 120;
+    run->pacing_info.fixed_update_callback_ex = test_update;
+    run->pacing_info.variable_update_callback_ex = test_update;
+    run->pacing_info.render_callback_ex = test_render;
+    run->pacing_info.user_data = run;
+
+    test_clock.now = 0;
+    SDL_FramePacing_SetClock(read_test_clock, test_clocks_per_second, &test_clock);
+    SDL_Internal_FramePacing_Init(NULL);
+}
+
+//one frame the way the sample loop runs it, with the swap at swap_time
+static void run_frame(TestRun* run, Uint64 swap_time) {
+    if(run->frame_count == run->max_frames) return;
+    test_clock.now = swap_time;
+    SDL_Internal_SwapBuffersAndMeasureTime_NonDXGI(NULL);
+    SDL_Internal_FramePacing_ComputeDeltaTime(NULL);
+
+    run->frames[run->frame_count++].swap_time = swap_time;
+    SDL_PaceFrame(SDL_GetFrameTime(), &run->pacing_info);
+}
+
+static void end_run() {
+    SDL_Internal_FramePacing_Shutdown();
+    SDL_FramePacing_SetClock(NULL, 0, NULL);
+}
+
+//measurements over frames [from, to)
+static double clocks_to_ms(double clocks) {
+    return clocks * 1000.0 / test_clocks_per_second;
+}
+
+//largest distance of a reported delta from expected
+static double max_jitter_ms(const TestRun* run, int from, int to, double expected_ms) {
+    double jitter = 0;
+    for(int i = from; i < to; i++) {
+        double error = fabs(run->frames[i].delta_time_ns / 1000000.0 - expected_ms);
+        if(error > jitter) jitter = error;
+    }
+    return jitter;
+}
+
+//reported time against real time since frame from, largest gap and the gap at the end
+static double drift_ms(const TestRun* run, int from, int to, bool at_end) {
+    double drift = 0;
+    for(int i = from; i < to; i++) {
+        double reported = (run->frames[i].timeline_ns - run->frames[from].timeline_ns) / 1000000.0;
+        double real = clocks_to_ms((double)(run->frames[i].swap_time - run->frames[from].swap_time));
+        drift = at_end?fabs(reported - real):fmax(drift, fabs(reported - real));
+    }
+    return drift;
+}
+
+//fixed ticks run against the reported time they should cover, the accumulator can only ever hold back a part of one tick
+//so the bound is that, not a tolerance: 1 is a tick lost or run twice, values just under it are a nearly full accumulator
+static const double max_held_back_ticks = 1;
+
+static double max_tick_error(const TestRun* run, int from, int to) {
+    double error = 0;
+    int ticks = 0;
+    for(int i = from; i < to; i++) {
+        ticks += run->frames[i].ticks;
+        double expected = (run->frames[i].timeline_ns - run->frames[from - 1].timeline_ns) / 1000000000.0 * run->pacing_info.update_rate;
+        error = fmax(error, fabs(ticks - expected));
+    }
+    return error;
+}
+
+static int count_unsynced(const TestRun* run, int from, int to) {
+    int count = 0;
+    for(int i = from; i < to; i++) count += run->frames[i].vsynced?0:1;
+    return count;
+}
+
+static int count_flips(const TestRun* run, int from, int to) {
+    int count = 0;
+    for(int i = from + 1; i < to; i++) count += run->frames[i].vsynced != run->frames[i-1].vsynced?1:0;
+    return count;
+}
+
+//frames after from until the detector settled on vsynced, and stayed there until to
+static int lock_time(const TestRun* run, int from, int to, bool vsynced) {
+    int locked = to;
+    for(int i = to - 1; i >= from && run->frames[i].vsynced == vsynced; i--) locked = i;
+    return locked - from;
+}
+
+//a refresh isnt a whole number of clocks (166666.67 at 60hz), the fraction is carried to the next frame so a delta snapped to
+//whole refreshes is off by under one clock. the bound for every scenario where the pacer should report exact refreshes
+static double snapped_jitter_ms() {
+    return clocks_to_ms(1);
+}
+
+static int failures;
+
+static void check(const char* name, const char* what, double value, double bound) {
+    bool ok = value <= bound;
+    printf("%s %-18s %-36s %10.4f  (max %g)\n", ok?"ok  ":"FAIL", name, what, value, bound);
+    if(!ok) failures++;
+}
+
+//golden traces, one line per frame. everything in them is integer, so they compare exactly across compilers
+static bool update_golden;
+
+static void check_golden(const TestRun* run) {
+    static char trace[TestRun::max_frames * 96];
+    int length = 0;
+    for(int i = 0; i < run->frame_count; i++) {
+        const TestFrame* frame = &run->frames[i];
+        length += snprintf(trace + length, sizeof(trace) - length, "%d %llu %llu %llu %d %d\n", i, (unsigned long long)(frame->swap_time - test_start_time),
+            (unsigned long long)frame->delta_time_ns, (unsigned long long)frame->timeline_ns, frame->ticks, frame->vsynced?1:0);
+    }
+
+    char path[256];
+    snprintf(path, sizeof(path), "tests/golden/%s.txt", run->name);
+    if(update_golden) {
+        FILE* file = fopen(path, "wb");
+        bool ok = file && fwrite(trace, 1, length, file) == (size_t)length;
+        if(file) ok = fclose(file) == 0 && ok;
+        printf("%s %-18s wrote %s\n", ok?"ok  ":"FAIL", run->name, path);
+        if(!ok) failures++;
+        return;
+    }
+
+    static char golden[sizeof(trace)];
+    FILE* file = fopen(path, "rb");
+    int golden_length = file?(int)fread(golden, 1, sizeof(golden), file):0;
+    if(file) fclose(file);
+    if(!file) {
+        printf("FAIL %-18s missing %s (run with --update to create it)\n", run->name, path);
+        failures++;
+        return;
+    }
+
+    //a checkout with line ending conversion turns the golden files into CRLF
+    int kept = 0;
+    for(int i = 0; i < golden_length; i++) {
+        if(golden[i] != '\r') golden[kept++] = golden[i];
+    }
+    golden_length = kept;
+
+    //report the first frame that differs, the rest usually just follows from it
+    int line = 0;
+    for(int i = 0; i < length || i < golden_length; i++) {
+        if(i >= length || i >= golden_length || trace[i] != golden[i]) {
+            printf("FAIL %-18s golden trace differs at frame %d\n", run->name, line);
+            failures++;
+            return;
+        }
+        if(trace[i] == '\n') line++;
+    }
+    printf("ok   %-18s golden trace matches (%d frames)\n", run->name, line);
+}
+
+//vsync on, every swap returns up to half a millisecond after its vblank (scheduling noise)
+static void test_swap_noise(TestRun* run) {
+    begin_run(run, "swap_noise");
+    TestRandom random = { 0x9e3779b97f4a7c15ull };
+    const double noise = .0005; //seconds
+    for(int i = 0; i < 600; i++) run_frame(run, vblank_time(i) + seconds_to_clocks(noise * test_random(&random)));
+    end_run();
+
+    double period_ms = 1000.0 / test_refresh_rate;
+    check(run->name, "unsynced frames", count_unsynced(run, 0, run->frame_count), 0);
+    check(run->name, "max jitter (ms)", max_jitter_ms(run, 1, run->frame_count, period_ms), snapped_jitter_ms());
+    //reported time stays on the vblank grid, real time is the grid plus this frames noise minus the first ones
+    check(run->name, "max drift (ms)", drift_ms(run, 1, run->frame_count, false), noise * 1000);
+    check(run->name, "tick error (ticks)", max_tick_error(run, 2, run->frame_count), max_held_back_ticks);
+    check_golden(run);
+}
+
+//vsync on, now and then a swap is measured late and the next one early, together they still cover two refreshes
+//(the OS recording the time late, not a missed vblank)
+static void test_long_short_glitch(TestRun* run) {
+    begin_run(run, "long_short_glitch");
+    TestRandom random = { 0x2545f4914f6cdd1dull };
+    double period = 1.0 / test_refresh_rate;
+    const double late_periods = .4; //how late the glitched swaps are measured
+    const double noise = .0001; //seconds
+    for(int i = 0; i < 600; i++) {
+        double late = i % 37 == 36?late_periods * period:0;
+        run_frame(run, vblank_time(i) + seconds_to_clocks(late + noise * test_random(&random)));
+    }
+    end_run();
+
+    double period_ms = period * 1000;
+    check(run->name, "unsynced frames", count_unsynced(run, 0, run->frame_count), 0);
+    check(run->name, "max jitter (ms)", max_jitter_ms(run, 1, run->frame_count, period_ms), snapped_jitter_ms());
+    //the reported time stays on the grid through a glitch, real time is ahead of it by the late swap and the noise until the next
+    //swap lands back on its vblank. the bound is exactly that: the margin over the measured value is what the noise didnt use
+    check(run->name, "max drift (ms)", drift_ms(run, 1, run->frame_count, false), late_periods * period_ms + noise * 1000);
+    check(run->name, "drift at end (ms)", drift_ms(run, 1, run->frame_count, true), noise * 1000);
+    check(run->name, "tick error (ticks)", max_tick_error(run, 2, run->frame_count), max_held_back_ticks);
+    check_golden(run);
+}
+
+//variable refresh rate with the frames taking about a refresh each: the display shows every frame as soon as it is done,
+//so the swaps never land on a grid, but runs of them stay close enough to one refresh to look vsynced for a while
+//the detector does flip back and forth on this (see the note at the end of SDL_Internal_SwapBuffersAndMeasureTime_NonDXGI),
+//what is bounded is how often, and how far the reported time strays from real time while it does
+static void test_vrr_flip_flop(TestRun* run) {
+    begin_run(run, "vrr_flip_flop");
+    TestRandom random = { 0xd1b54a32d192ed03ull };
+    double period = 1.0 / test_refresh_rate;
+    const double spread = .15; //periods a frame can take either side of one refresh
+    const int frame_count = 1200;
+    double time = 0;
+    for(int i = 0; i < frame_count; i++) {
+        run_frame(run, test_start_time + seconds_to_clocks(time));
+        time += period * (1 - spread + 2 * spread * test_random(&random));
+    }
+    end_run();
+
+    //these are budgets, the flip flop itself isnt fixed (see above). a flip every 50 frames at most
+    double period_ms = period * 1000;
+    check(run->name, "vsync flips", count_flips(run, 0, run->frame_count), frame_count / 50);
+    //a frame is up to spread off a refresh, and while it counts as vsynced a snapped frame carries its error into the next, so twice that
+    check(run->name, "max jitter (ms)", max_jitter_ms(run, 1, run->frame_count, period_ms), 2 * spread * period_ms);
+    //while wrongly vsynced every frame is reported as a whole refresh, what builds up before it flips back is paid back after.
+    //3 refreshes is how far behind or ahead the game is allowed to get meanwhile
+    check(run->name, "max drift (ms)", drift_ms(run, 1, run->frame_count, false), 3 * period_ms);
+    check(run->name, "tick error (ticks)", max_tick_error(run, 2, run->frame_count), max_held_back_ticks);
+    check_golden(run);
+}
+
+//cold start uncapped, then the app turns vsync on without telling the pacer, then toggles it twice more through NotifySwapIntervalChanged
+static void test_vsync_lock(TestRun* run) {
+    begin_run(run, "vsync_lock");
+    TestRandom random = { 0x853c49e6748fea9bull };
+    Uint64 time = test_start_time;
+    Uint64 refresh = 0;
+
+    //uncapped, ~400fps
+    for(int i = 0; i < 300; i++) {
+        time += seconds_to_clocks(.0025 + .0005 * test_random(&random));
+        run_frame(run, time);
+    }
+
+    //vsync on, unannounced, every swap waits for the next vblank
+    while(vblank_time(refresh) <= time) refresh++;
+    for(int i = 300; i < 700; i++) {
+        time = vblank_time(refresh++) + seconds_to_clocks(.0002 * test_random(&random));
+        run_frame(run, time);
+    }
+
+    //vsync off, announced
+    SDL_FramePacing_NotifySwapIntervalChanged(NULL, 0);
+    for(int i = 700; i < 900; i++) {
+        time += seconds_to_clocks(.0025 + .0005 * test_random(&random));
+        run_frame(run, time);
+    }
+
+    //and back on, announced
+    SDL_FramePacing_NotifySwapIntervalChanged(NULL, 1);
+    while(vblank_time(refresh) <= time) refresh++;
+    for(int i = 900; i < 1000; i++) {
+        time = vblank_time(refresh++) + seconds_to_clocks(.0002 * test_random(&random));
+        run_frame(run, time);
+    }
+    end_run();
+
+    //cold start assumes vsync, and the loose warmup threshold is there so that guess is dropped within the warmup frames
+    double period_ms = 1000.0 / test_refresh_rate;
+    VsyncEstimatorConfig config = VsyncEstimatorDefaultConfig();
+    check(run->name, "cold start frames to lose sync", lock_time(run, 0, 300, false), config.warmup_frames);
+    //unannounced, the uncapped frames have to leave the drift window before the estimator starts counting synced frames. that is the
+    //worst case, it starts counting a little sooner once the uncapped frames left in the window drift less than the threshold
+    check(run->name, "unannounced frames to lock", lock_time(run, 300, 700, true), config.window + config.frames_to_gain_sync);
+    //an announce sets the state outright, the only frame that can still disagree is the one measured across the switch (and the one
+    //after it, whose delta was taken from that swap)
+    check(run->name, "announced frames to unlock", lock_time(run, 700, 900, false), 2);
+    check(run->name, "announced frames to lock", lock_time(run, 900, 1000, true), 2);
+    check(run->name, "max jitter once locked (ms)", max_jitter_ms(run, 300 + lock_time(run, 300, 700, true) + 1, 700, period_ms), snapped_jitter_ms());
+    check(run->name, "max jitter after announce (ms)", max_jitter_ms(run, 901, 1000, period_ms), snapped_jitter_ms());
+    check(run->name, "tick error (ticks)", max_tick_error(run, 2, run->frame_count), max_held_back_ticks);
+    check_golden(run);
+}
+
+//the residual strategy on its own: frames that land the same distance off the grid every time have no spread,
+//but must not count as vsynced. feeds residual = offset (in periods) for a while and returns the decision
+static bool residual_decision(double offset, double noise, bool initial_guess) {
+    VsyncEstimatorConfig config = VsyncEstimatorDefaultConfig();
+    config.update = VsyncEstimatorResidualVariance;
+    VsyncEstimator estimator;
+    VsyncEstimatorInit(&estimator, &config, initial_guess);
+
+    TestRandom random = { 0x94d049bb133111ebull };
+    double period = 1.0 / test_refresh_rate;
+    for(int i = 0; i < 64; i++) {
+        VsyncEstimatorSample sample;
+        memset(&sample, 0, sizeof(sample));
+        sample.refresh_period = period;
+        sample.residual = (offset + noise * (test_random(&random) - .5)) * period;
+        sample.tolerance_scale = 1;
+        VsyncEstimatorUpdate(&estimator, &sample);
+    }
+    return estimator.is_vsynced;
+}
+
+static void test_residual_offset() {
+    const char* name = "residual_offset";
+    check(name, "on the grid, counted unsynced", residual_decision(0, .05, false)?0:1, 0);
+    check(name, "half a period off, counted vsynced", residual_decision(.5, 0, true)?1:0, 0);
+    check(name, "steady .3 off, counted vsynced", residual_decision(.3, .02, true)?1:0, 0);
+    check(name, "steady -.3 off, counted vsynced", residual_decision(-.3, .02, true)?1:0, 0);
+}
+
+int main(int argc, char* argv[]) {
+    for(int i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "--update") == 0) update_golden = true;
+    }
+
+    static TestRun run; //tens of kilobytes, keep it off the stack
+    test_swap_noise(&run);
+    test_long_short_glitch(&run);
+    test_vrr_flip_flop(&run);
+    test_vsync_lock(&run);
+    test_residual_offset();
+
+    printf(failures?"%d check(s) failed\n":"all checks passed\n", failures);
+    return failures?1:0;
+}
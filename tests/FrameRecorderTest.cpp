@@ -0,0 +1,252 @@
+//checks for FrameRecorder: records written by the frame thread read back field for field through the reader, with negative and
+//full width deltas, across the 64KB chunk boundaries, and with chunks dropped while the writer is behind (counted, and the records
+//after the gap still decode). also that the pacer only records frames it captured whole since SDL_FramePacing_StartRecording
+//
+//build it like the sample, with this file in place of FramePacing.cpp and FrameRecorder.cpp (both are included below, the recorders
+//internals are used to hold the writer back):
+//  cl /std:c++17 /EHsc /O2 /I. tests\FrameRecorderTest.cpp DXGISwapChainAdapter.cpp DisplayProfileCache.cpp DriftWindow.cpp FixedUpdatePool.cpp
+//     FrameTrace.cpp PresentQueue.cpp QuadBatch.cpp SharedTextureRing.cpp VsyncEstimator.cpp SDL3.lib opengl32.lib d3d11.lib dxgi.lib
+//returns non zero if anything failed, writes its scratch files to the working directory
+#define FRAME_PACING_NO_SAMPLE
+#include "../FramePacing.cpp"
+#include "../FrameRecorder.cpp"
+#include <chrono>
+#include <cstdio>
+
+static int failures;
+
+static void check(const char* name, const char* what, bool ok) {
+    printf("%s %-12s %s\n", ok?"ok  ":"FAIL", name, what);
+    if(!ok) failures++;
+}
+
+static const char* test_path = "frame_recorder_test.bin";
+static const char* second_test_path = "frame_recorder_test_2.bin";
+
+//record i of a run, ticks holds i so a record read back can be matched up even after a dropped chunk
+//timestamps step back now and then, sync_time counts down, expected_delta swings across most of the int64 range every record
+static void make_record(int i, FrameRecord* record) {
+    record->timestamp = 1000000000 + (int64_t)i * 16666667 - (i % 7 == 3?50000000:0);
+    record->sync_time = -(int64_t)i * 1234567;
+    record->present_count = i;
+    record->present_refresh_count = i / 2;
+    record->sync_refresh_count = i % 5 == 0?0:i;
+    record->measured_delta = i % 2?-(int64_t)i * 3:(int64_t)i * 3;
+    record->reported_delta = 16666667;
+    record->expected_delta = i % 2?(1ll << 61):-(1ll << 61);
+    record->ticks = i;
+    record->vsynced = i % 3 != 0;
+}
+
+static bool same_record(const FrameRecord* a, const FrameRecord* b) {
+    return a->timestamp == b->timestamp && a->sync_time == b->sync_time && a->present_count == b->present_count
+        && a->present_refresh_count == b->present_refresh_count && a->sync_refresh_count == b->sync_refresh_count
+        && a->measured_delta == b->measured_delta && a->reported_delta == b->reported_delta && a->expected_delta == b->expected_delta
+        && a->ticks == b->ticks && a->vsynced == b->vsynced;
+}
+
+//the writer runs whenever it likes, waiting for it to write out every queued chunk keeps a run from dropping chunks when it isnt meant to
+static void wait_for_writer() {
+    FrameRecorderInternal* info = &frame_recorder_info;
+    while(true) {
+        {
+            std::lock_guard<std::mutex> lock(info->mutex);
+            bool idle = info->queue_count == 0;
+            for(int c = 0; c < frame_recorder_chunk_count; c++) idle = idle && (c == info->active || info->chunk_free[c]);
+            if(idle) return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+//reads the whole file, checks every record against make_record for its index. returns the count, -1 if the file wouldnt open
+static int read_back(const char* path, bool* matched, int* first, int* last) {
+    FrameRecordReader* reader = FrameRecordReaderOpen(path);
+    if(!reader) return -1;
+    int count = 0;
+    *matched = true;
+    FrameRecord record, expected;
+    while(FrameRecordReaderNext(reader, &record)) {
+        make_record((int)record.ticks, &expected);
+        if(!same_record(&record, &expected)) *matched = false;
+        if(count == 0) *first = (int)record.ticks;
+        *last = (int)record.ticks;
+        count++;
+    }
+    FrameRecordReaderClose(reader);
+    return count;
+}
+
+static void test_round_trip() {
+    const char* name = "round trip";
+    check(name, "opens", FrameRecorderOpen(test_path, 10000000));
+
+    //under 30 bytes a record, so this crosses the 64KB chunk boundary a few times
+    const int record_count = 20000;
+    FrameRecord record;
+    int chunks_submitted = 0;
+    for(int i = 0; i < record_count; i++) {
+        int active = frame_recorder_info.active;
+        make_record(i, &record);
+        FrameRecorderAppend(&record);
+        if(frame_recorder_info.active != active) chunks_submitted++;
+        wait_for_writer();
+    }
+    FrameRecorderClose();
+    check(name, "spans several chunks", chunks_submitted >= 2);
+    check(name, "nothing dropped", FrameRecorderDroppedRecords() == 0);
+
+    bool matched = false;
+    int first = -1, last = -1;
+    int count = read_back(test_path, &matched, &first, &last);
+    FrameRecordReader* reader = FrameRecordReaderOpen(test_path);
+    check(name, "clocks per second comes back", reader && FrameRecordReaderClocksPerSecond(reader) == 10000000);
+    FrameRecordReaderClose(reader);
+    check(name, "every record comes back", count == record_count && first == 0 && last == record_count - 1);
+    check(name, "field for field, negative and wide deltas included", matched);
+}
+
+static void test_dropped() {
+    const char* name = "dropped";
+    FrameRecorderInternal* info = &frame_recorder_info;
+    FrameRecorderOpen(test_path, 10000000);
+    FrameRecord record;
+    int i = 0;
+    for(; i < 100; i++) {
+        make_record(i, &record);
+        FrameRecorderAppend(&record);
+    }
+
+    //the writer falling behind, as far behind as it gets: stopped, so every chunk filled stays queued and once they all are records are dropped
+    {
+        std::lock_guard<std::mutex> lock(info->mutex);
+        info->stop = true;
+        info->wake.notify_one();
+    }
+    info->writer.join();
+    info->stop = false;
+    const int behind_count = 20000;
+    int dropped_from = -1;
+    for(; i < behind_count; i++) {
+        make_record(i, &record);
+        FrameRecorderAppend(&record);
+        if(dropped_from < 0 && FrameRecorderDroppedRecords() > 0) dropped_from = i;
+    }
+    Uint64 dropped = FrameRecorderDroppedRecords();
+    check(name, "records are dropped once every chunk is queued", dropped_from > 100 && dropped == (Uint64)(behind_count - dropped_from));
+    check(name, "the frame thread holds no chunk meanwhile", info->active == -1 && info->queue_count == frame_recorder_chunk_count);
+
+    //the writer catches up, recording picks up again in a fresh chunk
+    info->writer = std::thread(writer_thread);
+    wait_for_writer();
+    for(; i < behind_count + 100; i++) {
+        make_record(i, &record);
+        FrameRecorderAppend(&record);
+    }
+    FrameRecorderClose();
+    check(name, "nothing more dropped once there is room", FrameRecorderDroppedRecords() == dropped);
+
+    //records up to the drop, then the ones after it, the first of those decodes against a keyframe
+    FrameRecordReader* reader = FrameRecordReaderOpen(test_path);
+    int count = 0, gap_at = -1;
+    bool matched = true;
+    FrameRecord expected;
+    int previous = -1;
+    while(reader && FrameRecordReaderNext(reader, &record)) {
+        make_record((int)record.ticks, &expected);
+        if(!same_record(&record, &expected)) matched = false;
+        if(record.ticks != previous + 1) gap_at = previous + 1;
+        previous = (int)record.ticks;
+        count++;
+    }
+    FrameRecordReaderClose(reader);
+    check(name, "read count is appended minus dropped", count == behind_count + 100 - (int)dropped);
+    check(name, "the gap is where the drops started", gap_at == dropped_from);
+    check(name, "records after the gap decode", matched && previous == behind_count + 99);
+}
+
+//the non-DXGI timing path with the swap timestamp set directly, no window
+struct RecordedRun {
+    SDL_FramePacingInfo pacing_info;
+    Uint64 swap_time;
+} recorded_run;
+
+static void recorded_update(const SDL_FramePacingContext* context, void* user_data) {
+}
+
+static void compute_delta_time() {
+    recorded_run.swap_time += SDL_GetPerformanceFrequency() / 60;
+    frame_timing_info_ndxgi.swap_time = recorded_run.swap_time;
+    SDL_Internal_FramePacing_ComputeDeltaTime(NULL);
+}
+
+static void pace_frame() {
+    SDL_PaceFrame(SDL_GetFrameTime(), &recorded_run.pacing_info);
+}
+
+static void test_pacer_start() {
+    const char* name = "pacer";
+    memset(&recorded_run, 0, sizeof(recorded_run));
+    recorded_run.pacing_info.update_rate = 60;
+    recorded_run.pacing_info.fixed_update_callback_ex = recorded_update;
+    recorded_run.pacing_info.variable_update_callback_ex = recorded_update;
+    recorded_run.pacing_info.render_callback_ex = recorded_update;
+    recorded_run.swap_time = SDL_GetPerformanceFrequency();
+    SDL_Internal_FramePacing_Init(NULL);
+
+    compute_delta_time();
+    pace_frame();
+
+    //started between ComputeDeltaTime and PaceFrame, this frame wasnt captured and must not be written
+    compute_delta_time();
+    SDL_FramePacing_StartRecording(test_path);
+    pace_frame();
+    Uint64 first_recorded = recorded_run.swap_time + SDL_GetPerformanceFrequency() / 60;
+    for(int f = 0; f < 2; f++) {
+        compute_delta_time();
+        pace_frame();
+    }
+
+    //stopped and restarted mid frame, the frame captured for the first file doesnt go into the second
+    compute_delta_time();
+    SDL_FramePacing_StopRecording();
+    SDL_FramePacing_StartRecording(second_test_path);
+    pace_frame();
+    Uint64 second_recorded = recorded_run.swap_time + SDL_GetPerformanceFrequency() / 60;
+    compute_delta_time();
+    pace_frame();
+    SDL_FramePacing_StopRecording();
+    SDL_Internal_FramePacing_Shutdown();
+
+    FrameRecord record;
+    FrameRecordReader* reader = FrameRecordReaderOpen(test_path);
+    int count = 0;
+    bool first_ok = false;
+    while(reader && FrameRecordReaderNext(reader, &record)) {
+        if(count == 0) first_ok = record.timestamp == (int64_t)first_recorded && record.measured_delta == (int64_t)SDL_GetPerformanceFrequency() / 60;
+        count++;
+    }
+    FrameRecordReaderClose(reader);
+    check(name, "a frame started before recording isnt written", count == 2 && first_ok);
+
+    reader = FrameRecordReaderOpen(second_test_path);
+    count = 0;
+    first_ok = false;
+    while(reader && FrameRecordReaderNext(reader, &record)) {
+        if(count == 0) first_ok = record.timestamp == (int64_t)second_recorded;
+        count++;
+    }
+    FrameRecordReaderClose(reader);
+    check(name, "a frame from the last recording isnt carried over", count == 1 && first_ok);
+}
+
+int main(int argc, char* argv[]) {
+    test_round_trip();
+    test_dropped();
+    test_pacer_start();
+
+    remove(test_path);
+    remove(second_test_path);
+    printf(failures?"%d check(s) failed\n":"all checks passed\n", failures);
+    return failures?1:0;
+}
@@ -0,0 +1,199 @@
+//checks for gpu timing in SDL_PaceFrame, with a fake SDL_FramePacingGpuQueryProvider that reports scripted gpu times a set number of
+//frames late, no GL context needed. the timing backend is skipped too: each frame sets the delta the pacer measured at the last present
+//directly, so the frames classify against known gpu / swap times
+//  readback: queries are read back in order once ready, never waited on, context->gpu_time and the hitch report the latest result from
+//            before the frame started
+//  classification: a frame late because of the gpu is a render overrun, the same frame with the gpu in budget is a present stall or
+//                  os scheduling depending on the swap wait
+//
+//build it like the sample, with this file in place of FramePacing.cpp (it is included below, without the sample main):
+//  cl /std:c++17 /EHsc /O2 /I. tests\GpuTimingTest.cpp DXGISwapChainAdapter.cpp DisplayProfileCache.cpp DriftWindow.cpp FixedUpdatePool.cpp
+//     FrameRecorder.cpp FrameTrace.cpp PresentQueue.cpp QuadBatch.cpp SharedTextureRing.cpp VsyncEstimator.cpp SDL3.lib opengl32.lib d3d11.lib dxgi.lib
+//returns non zero if anything failed
+#define FRAME_PACING_NO_SAMPLE
+#include "../FramePacing.cpp"
+#include <cstdio>
+
+//gpu time of every query, by the order they were issued in. a result is ready once ready_after more frames have begun
+struct FakeGpu {
+    static const int max_queries = 256;
+    Uint64 nanoseconds[max_queries]; //what the query issued n-th reports
+    int issued_frame[max_queries]; //frame the query was ended in
+    int ready_after;
+    int frame;
+    unsigned int query_ids[8];
+    int created;
+    int issued;
+    int active; //query between begin and end, -1 if none
+    int results_read;
+    int polls_not_ready;
+    bool double_begin; //begin while another query was still open
+} fake_gpu;
+
+static int fake_index(unsigned int query) { //which of the created queries, the pacer reuses them round robin
+    for(int i = 0; i < fake_gpu.created; i++) if(fake_gpu.query_ids[i] == query) return i;
+    return -1;
+}
+
+//the n-th query sits in query slot n % created, the pacer always reads the oldest outstanding one
+static int slot_query_number[8];
+
+static void fake_create_queries(int count, unsigned int* queries, void* user_data) {
+    for(int i = 0; i < count; i++) queries[i] = fake_gpu.query_ids[i] = 100 + i;
+    fake_gpu.created = count;
+}
+static void fake_begin_query(unsigned int query, void* user_data) {
+    if(fake_gpu.active >= 0) fake_gpu.double_begin = true;
+    fake_gpu.active = fake_index(query);
+    slot_query_number[fake_gpu.active] = fake_gpu.issued;
+}
+static void fake_end_query(unsigned int query, void* user_data) {
+    fake_gpu.issued_frame[fake_gpu.issued % FakeGpu::max_queries] = fake_gpu.frame;
+    fake_gpu.issued++;
+    fake_gpu.active = -1;
+}
+static bool fake_get_query_result(unsigned int query, Uint64* nanoseconds, void* user_data) {
+    int number = slot_query_number[fake_index(query)];
+    if(fake_gpu.frame - fake_gpu.issued_frame[number % FakeGpu::max_queries] < fake_gpu.ready_after) {
+        fake_gpu.polls_not_ready++;
+        return false;
+    }
+    *nanoseconds = fake_gpu.nanoseconds[number % FakeGpu::max_queries];
+    fake_gpu.results_read++;
+    return true;
+}
+
+struct GpuFrame {
+    bool hitched;
+    SDL_FramePacing_HitchClass hitch_class;
+    double gpu_time; //context->gpu_time in the render callback
+};
+
+struct GpuRun {
+    static const int max_frames = 64;
+    GpuFrame frames[max_frames];
+    int frame_count;
+    double hitch_gpu_time; //from the last hitch callback
+    SDL_FramePacingInfo pacing_info;
+} gpu_run;
+
+static void gpu_update(const SDL_FramePacingContext* context, void* user_data) {
+}
+
+static void gpu_render(const SDL_FramePacingContext* context, void* user_data) {
+    GpuFrame* frame = &gpu_run.frames[gpu_run.frame_count];
+    frame->hitched = context->hitched;
+    frame->hitch_class = context->hitch_class;
+    frame->gpu_time = context->gpu_time;
+}
+
+static void gpu_hitch(const SDL_FramePacingHitch* hitch, void* user_data) {
+    gpu_run.hitch_gpu_time = hitch->gpu_time;
+}
+
+static int failures;
+
+static void check(const char* name, const char* what, bool ok) {
+    printf("%s %-12s %s\n", ok?"ok  ":"FAIL", name, what);
+    if(!ok) failures++;
+}
+
+static int64_t ms_to_clocks(double ms) {
+    return (int64_t)(ms * frame_timing_info.clocks_per_second / 1000.0);
+}
+
+static void begin_gpu_run(int ready_after) {
+    memset(&fake_gpu, 0, sizeof(fake_gpu));
+    fake_gpu.ready_after = ready_after;
+    fake_gpu.active = -1;
+    memset(&gpu_run, 0, sizeof(gpu_run));
+    gpu_run.pacing_info.update_rate = 60;
+    gpu_run.pacing_info.fixed_update_callback_ex = gpu_update;
+    gpu_run.pacing_info.variable_update_callback_ex = gpu_update;
+    gpu_run.pacing_info.render_callback_ex = gpu_render;
+
+    SDL_Internal_FramePacing_Init(NULL);
+    SDL_FramePacingGpuQueryProvider provider = { fake_create_queries, fake_begin_query, fake_end_query, fake_get_query_result, NULL };
+    SDL_FramePacing_EnableGpuTiming(&provider);
+    SDL_FramePacing_SetHitchCallback(gpu_hitch, NULL);
+}
+
+//one frame, as if the last present came measured_ms after the one before with swap_wait_ms of it blocked in swap
+//the cpu phases are the test callbacks, which take next to nothing
+static void run_gpu_frame(double measured_ms, double swap_wait_ms) {
+    frame_timing_info.expected_delta_time = ms_to_clocks(1000.0 / 60);
+    frame_timing_info.measured_delta_time = ms_to_clocks(measured_ms);
+    frame_timing_info.swap_wait_time = ms_to_clocks(swap_wait_ms);
+    SDL_PaceFrame(frame_timing_info.expected_delta_time, &gpu_run.pacing_info);
+    gpu_run.frame_count++;
+    fake_gpu.frame++;
+}
+
+static void test_readback() {
+    const char* name = "readback";
+    begin_gpu_run(2);
+    for(int i = 0; i < FakeGpu::max_queries; i++) fake_gpu.nanoseconds[i] = 1000000 * (Uint64)(i + 1); //query n took n+1 ms
+
+    bool lagged = true;
+    for(int f = 0; f < 12; f++) {
+        run_gpu_frame(1000.0 / 60, 0);
+        //the context is filled in before this frames readback, so it has what the last render read: the query from ready_after frames before that
+        double expected = f < 3?0:(f - 3 + 1) / 1000.0;
+        if(fabs(gpu_run.frames[f].gpu_time - expected) > 1e-6) lagged = false;
+    }
+    check(name, "gpu_time is the result from ready_after frames ago", lagged);
+    check(name, "SDL_GetGpuFrameTime has the newest result", fabs(SDL_GetGpuFrameTime() - (11 - 2 + 1) / 1000.0) < 1e-6);
+    check(name, "one query per frame, opened and closed in order", fake_gpu.issued == 12 && !fake_gpu.double_begin && fake_gpu.active == -1);
+    check(name, "results that werent ready were polled, not waited on", fake_gpu.polls_not_ready > 0);
+
+    //the gpu falls behind past every query: frames go unmeasured instead of waiting
+    begin_gpu_run(1000);
+    for(int f = 0; f < 8; f++) run_gpu_frame(1000.0 / 60, 0);
+    check(name, "all queries pending skips the measurement", fake_gpu.issued == FrameGpuTimingInternal::query_count && fake_gpu.results_read == 0);
+}
+
+static void test_classification() {
+    const char* name = "classify";
+    begin_gpu_run(1);
+    double refresh_ms = 1000.0 / 60;
+    for(int i = 0; i < FakeGpu::max_queries; i++) fake_gpu.nanoseconds[i] = 4000000; //4ms, well inside a refresh
+
+    //settle with on time frames, none of them hitch
+    for(int f = 0; f < 4; f++) run_gpu_frame(refresh_ms, refresh_ms - 4);
+    bool none = true;
+    for(int f = 0; f < 4; f++) none = none && !gpu_run.frames[f].hitched;
+    check(name, "on time frames dont hitch", none);
+
+    //the gpu takes 30ms from query 4 on, its results show up a frame late and each frame then spans two refreshes
+    for(int i = 4; i < FakeGpu::max_queries; i++) fake_gpu.nanoseconds[i] = 30000000;
+    run_gpu_frame(refresh_ms, 0); //query 4 issued, query 3 (4ms) read back
+    run_gpu_frame(2 * refresh_ms, 2 * refresh_ms - 1); //query 4 (30ms) read back before this frames render
+    run_gpu_frame(2 * refresh_ms, 2 * refresh_ms - 1);
+    const GpuFrame* gpu_bound = &gpu_run.frames[gpu_run.frame_count - 1];
+    check(name, "gpu bound frame is a render overrun", gpu_bound->hitched && gpu_bound->hitch_class == SDL_FRAMEPACING_HITCH_RENDER_OVERRUN);
+    check(name, "context gpu_time is the gpu result", fabs(gpu_bound->gpu_time - .030) < 1e-6);
+    check(name, "the hitch reports it too", fabs(gpu_run.hitch_gpu_time - .030) < 1e-6);
+    check(name, "counted as a render overrun", SDL_FramePacing_GetHitchCount(SDL_FRAMEPACING_HITCH_RENDER_OVERRUN) >= 1);
+
+    //same late frame with the gpu back in budget: blocked in swap for over a refresh is a present stall, otherwise nothing explains it
+    for(int i = 0; i < FakeGpu::max_queries; i++) fake_gpu.nanoseconds[i] = 4000000;
+    for(int f = 0; f < 3; f++) run_gpu_frame(refresh_ms, refresh_ms - 4); //flush the 30ms results out
+    run_gpu_frame(2 * refresh_ms, 2 * refresh_ms - 1);
+    const GpuFrame* stalled = &gpu_run.frames[gpu_run.frame_count - 1];
+    check(name, "gpu in budget, long swap is a present stall", stalled->hitched && stalled->hitch_class == SDL_FRAMEPACING_HITCH_PRESENT_STALL);
+    check(name, "with the gpu time it had", fabs(stalled->gpu_time - .004) < 1e-6);
+    run_gpu_frame(2 * refresh_ms, 1);
+    const GpuFrame* scheduled = &gpu_run.frames[gpu_run.frame_count - 1];
+    check(name, "gpu in budget, short swap is os scheduling", scheduled->hitched && scheduled->hitch_class == SDL_FRAMEPACING_HITCH_OS_SCHEDULING);
+
+    SDL_FramePacing_SetHitchCallback(NULL, NULL);
+    SDL_Internal_FramePacing_Shutdown();
+}
+
+int main(int argc, char* argv[]) {
+    test_readback();
+    test_classification();
+
+    printf(failures?"%d check(s) failed\n":"all checks passed\n", failures);
+    return failures?1:0;
+}
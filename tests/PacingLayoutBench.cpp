@@ -0,0 +1,250 @@
+//microbenchmark for the layout of the pacing state in FramePacing.cpp, old shapes against the current ones
+//  cold frame: the non-DXGI timing block as it was (drift history inline, residuals ahead of the estimators scalars, the error ring ahead of
+//              the drift windows counters) against the real frame_timing_info_ndxgi / frame_drift_history_info, with the cache flushed
+//              between frames the way a game frame would
+//  false sharing: a frame thread writing frame_idle_info while another thread reads frame_clock_info, packed into one line against the
+//                 real alignas(64) blocks
+//the new side is the pacers own state, the old side rearranges the same fields (checked below), the per frame work touches the fields
+//SDL_Internal_SwapBuffersAndMeasureTime_NonDXGI does
+//
+//build it like the sample, with this file in place of FramePacing.cpp (it is included below, without the sample main):
+//  cl /std:c++17 /EHsc /O2 /I. tests\PacingLayoutBench.cpp DXGISwapChainAdapter.cpp DisplayProfileCache.cpp DriftWindow.cpp FixedUpdatePool.cpp
+//     FrameRecorder.cpp FrameTrace.cpp PresentQueue.cpp QuadBatch.cpp SharedTextureRing.cpp VsyncEstimator.cpp SDL3.lib opengl32.lib d3d11.lib dxgi.lib
+#define FRAME_PACING_NO_SAMPLE
+#include "../FramePacing.cpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+static const int drift_max_length = DriftWindow::max_length;
+static const int drift_block_length = DriftWindow::block_length;
+static const int drift_max_blocks = DriftWindow::max_blocks;
+static const int residual_window = VsyncEstimator::max_residual_window;
+
+//before the split, the same fields in their old order
+struct OldDriftWindow {
+    int32_t errors[drift_max_length];
+    int length;
+    int index;
+    int count;
+    int drift_length;
+    int64_t drift;
+    double block_sum[drift_max_blocks];
+    double block_squares[drift_max_blocks];
+    double block_moment1[drift_max_blocks];
+    double block_moment2[drift_max_blocks];
+    int block_outliers[drift_max_blocks];
+    double outlier_threshold;
+};
+struct OldEstimator {
+    VsyncEstimatorConfig config;
+    bool is_vsynced;
+    int counter;
+    int64_t frames;
+    double residuals[residual_window];
+    int residual_count;
+    int residual_index;
+    double log_likelihood_ratio;
+};
+struct OldTimingNonDXGI {
+    int64_t swap_time;
+    int64_t swap_duration;
+    int64_t refresh_numerator;
+    int64_t refresh_denominator;
+    OldDriftWindow drift_window;
+    int64_t snap_error;
+    OldEstimator estimator;
+    int detection_grace;
+};
+
+//a field added to the real ones has to be added here too, or the old side is lighter than it was
+static_assert(sizeof(OldDriftWindow) == sizeof(DriftWindow), "OldDriftWindow is out of step with DriftWindow");
+static_assert(sizeof(OldEstimator) == sizeof(VsyncEstimator), "OldEstimator is out of step with VsyncEstimator");
+static_assert(offsetof(OldTimingNonDXGI, detection_grace) + sizeof(int) - sizeof(OldDriftWindow) - sizeof(OldEstimator)
+    == offsetof(FrameTimingInternal_NonDXGI, detection_grace) + sizeof(int), "OldTimingNonDXGI is out of step with FrameTimingInternal_NonDXGI");
+
+//what one swap does to the timing state: snap the delta, push the drift, feed the estimator
+template<typename Timing, typename Window>
+static bool pacing_frame(Timing* timing, Window* window, int64_t now) {
+    int64_t delta = now - timing->swap_time;
+    timing->swap_duration = delta & 0xff;
+    timing->swap_time = now;
+    int64_t period = timing->refresh_numerator?1000000000 * timing->refresh_denominator / timing->refresh_numerator:delta;
+    int64_t snapped = (delta + period / 2) / period * period;
+    timing->snap_error += delta - snapped;
+
+    int32_t error = (int32_t)(delta - snapped);
+    int oldest = (window->index - window->drift_length + window->length) % window->length;
+    window->drift += error - (window->count >= window->drift_length?window->errors[oldest]:0);
+    window->errors[window->index] = error;
+    window->index = (window->index + 1) % window->length;
+    if(window->count < window->length) window->count++;
+    if(window->index % drift_block_length == 0) {
+        int block = (window->index + window->length - drift_block_length) % window->length / drift_block_length;
+        window->block_sum[block] = 0;
+        for(int i = 0; i < drift_block_length; i++) window->block_sum[block] += window->errors[block * drift_block_length + i];
+    }
+
+    auto* estimator = &timing->estimator;
+    estimator->frames++;
+    estimator->residuals[estimator->residual_index] = (double)error / period;
+    estimator->residual_index = (estimator->residual_index + 1) % residual_window;
+    if(estimator->residual_count < residual_window) estimator->residual_count++;
+    estimator->log_likelihood_ratio += estimator->residuals[estimator->residual_index] > estimator->config.hit_threshold?-.1:.1;
+    if(timing->detection_grace > 0) timing->detection_grace--;
+    else if(window->drift > estimator->config.threshold * period) estimator->counter++;
+    else estimator->counter--;
+    estimator->is_vsynced = estimator->counter < estimator->config.frames_to_lose_sync;
+    return estimator->is_vsynced;
+}
+
+template<typename Timing, typename Window>
+static void setup(Timing* timing, Window* window) {
+    memset(timing, 0, sizeof(Timing));
+    memset(window, 0, sizeof(Window));
+    timing->refresh_numerator = 60000;
+    timing->refresh_denominator = 1001;
+    timing->estimator.config = VsyncEstimatorDefaultConfig();
+    window->length = 4096;
+    window->drift_length = 60;
+}
+
+//a game frame in between pushes the pacing state out of the cache, walking a buffer bigger than the last level does the same
+static const size_t evict_size = 32 << 20;
+static char* evict_buffer;
+static volatile int evict_sink;
+
+static void evict() {
+    int sum = 0;
+    for(size_t i = 0; i < evict_size; i += 64) {
+        evict_buffer[i]++;
+        sum += evict_buffer[i];
+    }
+    evict_sink = sum;
+}
+
+//average clocks per pacing_frame, cold or warm
+template<typename Timing, typename Window>
+static double time_frames(Timing* timing, Window* window, int frames, bool cold) {
+    Uint64 total = 0;
+    int64_t now = 0;
+    int vsynced = 0;
+    for(int f = 0; f < frames; f++) {
+        if(cold) evict();
+        now += 16683333 + (f * 7919 % 200000) - 100000;
+        Uint64 start = SDL_GetPerformanceCounter();
+        vsynced += pacing_frame(timing, window, now);
+        total += SDL_GetPerformanceCounter() - start;
+    }
+    evict_sink += vsynced;
+    return (double)total / frames;
+}
+
+//old: the drift window sits inside the timing block. new: the pacers own frame_timing_info_ndxgi and frame_drift_history_info
+static OldTimingNonDXGI old_timing;
+
+static void bench_cold_frame() {
+    const int frames = 1000;
+    double ns_per_clock = 1e9 / SDL_GetPerformanceFrequency();
+
+    printf("per frame pacing state update (ns)        old       new\n");
+    for(int cold = 1; cold >= 0; cold--) {
+        setup(&old_timing, &old_timing.drift_window);
+        setup(&frame_timing_info_ndxgi, &frame_drift_history_info.window);
+        //interleave so clock / turbo drift hits both the same
+        double old_clocks = 0, new_clocks = 0;
+        for(int round = 0; round < 5; round++) {
+            old_clocks += time_frames(&old_timing, &old_timing.drift_window, frames / 5, cold != 0);
+            new_clocks += time_frames(&frame_timing_info_ndxgi, &frame_drift_history_info.window, frames / 5, cold != 0);
+        }
+        printf("  %-38s %8.1f  %8.1f\n", cold?"cold cache (after a game frame)":"warm cache (back to back)", old_clocks / 5 * ns_per_clock, new_clocks / 5 * ns_per_clock);
+    }
+}
+
+//frame_idle_info (written every frame by the frame thread) and frame_clock_info (read by whoever calls the pacer clock) without their
+//alignas(64), next to each other in one line
+struct PackedIdleBlock {
+    int frames_before_idle;
+    int idle_swap_interval;
+    int unchanged_frames;
+    bool saw_input;
+    bool reported_unchanged;
+    bool is_idle;
+    int refresh_multiple;
+};
+struct PackedClockBlock {
+    SDL_FramePacing_ClockCallback callback;
+    Uint64 clocks_per_second;
+    void* user_data;
+};
+static_assert(offsetof(PackedIdleBlock, refresh_multiple) == offsetof(FrameIdleInternal, refresh_multiple), "PackedIdleBlock is out of step with FrameIdleInternal");
+static_assert(offsetof(PackedClockBlock, user_data) == offsetof(FrameClockInternal, user_data), "PackedClockBlock is out of step with FrameClockInternal");
+
+struct PackedBlocks {
+    PackedIdleBlock idle;
+    PackedClockBlock clock;
+};
+alignas(64) static PackedBlocks packed_blocks;
+
+//frame thread writes idle, the other thread keeps reading clock, returns clocks per frame thread iteration
+template<typename Idle, typename Clock>
+static double time_false_sharing(Idle* idle_block, Clock* clock_block, int iterations) {
+    std::atomic<bool> done(false);
+    std::atomic<bool> started(false);
+    std::thread reader([&] {
+        volatile Clock* clock = clock_block;
+        Uint64 sum = 0;
+        started.store(true);
+        while(!done.load(std::memory_order_relaxed)) sum += clock->clocks_per_second + (Uint64)(uintptr_t)clock->callback;
+        evict_sink += (int)sum;
+    });
+    while(!started.load()) std::this_thread::yield();
+
+    volatile Idle* idle = idle_block;
+    Uint64 start = SDL_GetPerformanceCounter();
+    for(int i = 0; i < iterations; i++) {
+        idle->unchanged_frames = idle->unchanged_frames + 1;
+        idle->refresh_multiple = i;
+    }
+    Uint64 total = SDL_GetPerformanceCounter() - start;
+
+    done.store(true);
+    reader.join();
+    return (double)total / iterations;
+}
+
+static void bench_false_sharing() {
+    const int iterations = 10000000;
+    double ns_per_clock = 1e9 / SDL_GetPerformanceFrequency();
+    packed_blocks.clock.clocks_per_second = SDL_GetPerformanceFrequency();
+    frame_clock_info.clocks_per_second = SDL_GetPerformanceFrequency(); //the pacer isnt running, its blocks are only memory here
+    bool aligned_shares = (uintptr_t)&frame_idle_info / 64 == (uintptr_t)&frame_clock_info / 64;
+
+    printf("neighbouring block read from another thread   packed    alignas(64)\n");
+    printf("  blocks share a line                          %s       %s\n", offsetof(PackedBlocks, clock) / 64 == 0?"yes":"no ", aligned_shares?"yes":"no ");
+    double packed = 0, aligned = 0;
+    for(int round = 0; round < 3; round++) {
+        packed += time_false_sharing(&packed_blocks.idle, &packed_blocks.clock, iterations);
+        aligned += time_false_sharing(&frame_idle_info, &frame_clock_info, iterations);
+    }
+    printf("  frame thread write (ns)                      %6.2f    %6.2f\n", packed / 3 * ns_per_clock, aligned / 3 * ns_per_clock);
+}
+
+int main(int argc, char* argv[]) {
+    evict_buffer = (char*)malloc(evict_size);
+    memset(evict_buffer, 1, evict_size);
+
+    printf("old non-DXGI timing block %d bytes, hot fields span %d bytes\n", (int)sizeof(OldTimingNonDXGI), (int)(offsetof(OldTimingNonDXGI, detection_grace) + sizeof(int)));
+    printf("new non-DXGI timing block %d bytes, hot fields span %d bytes (+ drift window counters %d bytes)\n\n", (int)sizeof(FrameTimingInternal_NonDXGI),
+        (int)(offsetof(FrameTimingInternal_NonDXGI, estimator) + offsetof(VsyncEstimator, residuals)), (int)offsetof(DriftWindow, errors));
+
+    bench_cold_frame();
+    printf("\n");
+    bench_false_sharing();
+
+    free(evict_buffer);
+    return 0;
+}
@@ -0,0 +1,228 @@
+//checks for PresentQueue against a fake present callback, no swapchain or display needed
+//  timings: what the present thread publishes through the seqlock is what SDL_Internal_FramePacing_ComputeDeltaTime sees, through
+//           stand-ins for the DXGISwapChainAdapter getters that read the queue the way the real adapter does with a present thread
+//  back-pressure: with the present thread stuck, the main thread gets capacity (the adapters ring count - 1) frames ahead and then blocks
+//  drain: doesnt return while a frame is still being presented, and returns right away when nothing is queued
+//
+//build it like the sample, with this file in place of FramePacing.cpp and without DXGISwapChainAdapter.cpp (faked below):
+//  cl /std:c++17 /EHsc /O2 /I. tests\PresentQueueTest.cpp DisplayProfileCache.cpp DriftWindow.cpp FixedUpdatePool.cpp FrameRecorder.cpp
+//     FrameTrace.cpp PresentQueue.cpp QuadBatch.cpp VsyncEstimator.cpp SDL3.lib opengl32.lib
+//returns non zero if anything failed
+#define FRAME_PACING_NO_SAMPLE
+#include "../FramePacing.cpp"
+#include "../PresentQueue.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+//what the fake display does with each frame: the slot says how many refreshes it stays up for, more than 1 is a missed present
+struct FakeDisplay {
+    int64_t start; //vblank 0
+    int64_t clocks_per_second;
+    Uint64 vblank; //the last frame went up at this one
+    Uint64 missed_presents;
+    int64_t present_block_time; //reported for every present
+    std::atomic<bool> held; //the present thread waits here while set, like a driver stuck in present
+    std::atomic<int> presents;
+} fake_display;
+
+static int64_t fake_vblank_time(Uint64 n) {
+    return fake_display.start + (int64_t)n * fake_display.clocks_per_second / 60;
+}
+
+static void fake_present(const PresentQueueFrame* frame, PresentQueueTimings* timings, void* user_data) {
+    while(fake_display.held.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    int refreshes = frame->slot > 1?frame->slot:1;
+    fake_display.vblank += refreshes * frame->sync_interval;
+    fake_display.missed_presents += (refreshes - 1) * frame->sync_interval;
+
+    timings->present_timestamp = fake_vblank_time(fake_display.vblank);
+    timings->sync_time = timings->present_timestamp;
+    timings->present_count++;
+    timings->present_refresh_count = timings->sync_refresh_count = (unsigned int)fake_display.vblank;
+    timings->present_block_time = fake_display.present_block_time;
+    timings->vsynced = frame->sync_interval > 0;
+    timings->missed_presents = fake_display.missed_presents;
+    fake_display.presents++;
+}
+
+//the adapter, reduced to a present queue and the getters FramePacing.cpp calls. with a present thread the real ones read the same snapshot
+struct DXGISwapChainAdapter {
+    PresentQueue* present_queue;
+    int64_t submit_block_time;
+};
+
+static PresentQueueTimings read_timings(DXGISwapChainAdapter* context) {
+    PresentQueueTimings timings;
+    PresentQueueReadTimings(context->present_queue, &timings);
+    return timings;
+}
+
+int DXGISwapChainAdapterGetFrameLatency(DXGISwapChainAdapter* context) { return 1; }
+int64_t DXGISwapChainAdapterGetPresentTimestamp(DXGISwapChainAdapter* context) { return read_timings(context).present_timestamp; }
+bool DXGISwapChainAdapterIsActuallyVsynced(DXGISwapChainAdapter* context) { return read_timings(context).vsynced; }
+int64_t DXGISwapChainAdapterGetSwapWaitTime(DXGISwapChainAdapter* context) { return context->submit_block_time; }
+Uint64 DXGISwapChainAdapterGetMissedPresents(DXGISwapChainAdapter* context) { return read_timings(context).missed_presents; }
+int64_t DXGISwapChainAdapterGetTimingMethodDelta(DXGISwapChainAdapter* context) { return read_timings(context).timing_method_delta; }
+FrameStatistics DXGISwapChainAdapterGetFrameStatistics(DXGISwapChainAdapter* context) {
+    PresentQueueTimings timings = read_timings(context);
+    FrameStatistics stats = { timings.sync_time, timings.present_count, timings.present_refresh_count, timings.sync_refresh_count };
+    return stats;
+}
+void DXGISwapChainAdapterRefreshRateRational(DXGISwapChainAdapter* context, int64_t* numerator, int64_t* denominator) {
+    *numerator = 60;
+    *denominator = 1;
+}
+void DXGISwapChainAdapterResetVsyncDetection(DXGISwapChainAdapter* context, bool assume_vsynced) {}
+void DXGISwapChainAdapterSetRefreshRate(DXGISwapChainAdapter* context, int64_t numerator, int64_t denominator) {}
+bool DXGISwapChainAdapterUpdateRefreshRate(DXGISwapChainAdapter* context) { return false; }
+
+static int failures;
+
+static void check(const char* name, const char* what, bool ok) {
+    printf("%s %-12s %s\n", ok?"ok  ":"FAIL", name, what);
+    if(!ok) failures++;
+}
+
+static void reset_fake_display() {
+    fake_display.clocks_per_second = (int64_t)SDL_GetPerformanceFrequency();
+    fake_display.start = (int64_t)SDL_GetPerformanceCounter();
+    fake_display.vblank = 0;
+    fake_display.missed_presents = 0;
+    fake_display.present_block_time = fake_display.clocks_per_second / 500;
+    fake_display.held = false;
+    fake_display.presents = 0;
+}
+
+static void test_timings() {
+    const char* name = "timings";
+    reset_fake_display();
+    SDL_Internal_FramePacing_Init(NULL);
+    DXGISwapChainAdapter adapter = { CreatePresentQueue(2, fake_present, NULL), 0 };
+
+    //refreshes each frame stays up for, the 2s and the 3 miss presents
+    const int frame_refreshes[] = { 1, 1, 1, 2, 1, 1, 3, 1, 1, 1 };
+    const int frame_count = sizeof(frame_refreshes) / sizeof(frame_refreshes[0]);
+    bool deltas_ok = true, snapped_ok = true, missed_ok = true, vsynced_ok = true, wait_ok = true, count_ok = true;
+    for(int i = 0; i < frame_count; i++) {
+        PresentQueueFrame frame = { frame_refreshes[i], 1 };
+        adapter.submit_block_time = PresentQueueSubmit(adapter.present_queue, &frame);
+        PresentQueueDrain(adapter.present_queue); //so the snapshot is this frames, a real frame would read whatever was published last
+        int64_t before = fake_vblank_time(fake_display.vblank - frame_refreshes[i]);
+
+        SDL_Internal_FramePacing_ComputeDeltaTime(&adapter);
+        if(i > 0 && frame_timing_info.measured_delta_time != fake_vblank_time(fake_display.vblank) - before) deltas_ok = false;
+        //snapped to whole refreshes, the fractional remainder is carried so one clock either way
+        int64_t expected = fake_display.clocks_per_second * frame_refreshes[i] / 60;
+        if(i > 0 && llabs(frame_timing_info.delta_time - expected) > 1) snapped_ok = false;
+        if(frame_timing_info.missed_refreshes != frame_refreshes[i] - 1) missed_ok = false;
+        if(!frame_timing_info.is_vsynced) vsynced_ok = false;
+        if(frame_timing_info.swap_wait_time != adapter.submit_block_time) wait_ok = false;
+        if(read_timings(&adapter).frames_presented != (Uint64)i + 1) count_ok = false;
+    }
+    check(name, "present timestamps become the measured delta", deltas_ok);
+    check(name, "deltas snap to the refreshes each frame spanned", snapped_ok);
+    check(name, "missed presents become missed refreshes", missed_ok);
+    check(name, "vsync state comes through", vsynced_ok);
+    check(name, "swap wait is the submit block time", wait_ok);
+    check(name, "frames_presented counts every present", count_ok);
+
+    //after a drain the main thread can replace the snapshot (a vsync reset does), the count stays the present threads
+    PresentQueueTimings replaced = read_timings(&adapter);
+    replaced.missed_presents = 0;
+    replaced.frames_presented = 0;
+    PresentQueuePublishTimings(adapter.present_queue, &replaced);
+    PresentQueueTimings read = read_timings(&adapter);
+    check(name, "published snapshot replaces the present threads", read.missed_presents == 0 && read.frames_presented == (Uint64)frame_count);
+
+    DestroyPresentQueue(adapter.present_queue);
+    SDL_Internal_FramePacing_Shutdown();
+}
+
+static void test_back_pressure() {
+    const char* name = "pressure";
+    reset_fake_display();
+    const int ring_count = 3; //what BALANCED / THROUGHPUT give the adapter, the present thread gets one less to keep one for rendering
+    const int capacity = ring_count - 1;
+    PresentQueue* queue = CreatePresentQueue(capacity, fake_present, NULL);
+    check(name, "capacity is what was asked for", PresentQueueCapacity(queue) == capacity);
+
+    //stuck in the first present, the main thread gets capacity frames in (the one being presented holds its slot) and blocks on the next
+    fake_display.held = true;
+    std::atomic<int> submitted(0);
+    int64_t last_block_time = 0;
+    std::thread main_thread([&] {
+        for(int i = 0; i < capacity + 1; i++) {
+            PresentQueueFrame frame = { 1, 1 };
+            last_block_time = PresentQueueSubmit(queue, &frame);
+            submitted++;
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    check(name, "capacity frames go in without blocking", submitted == capacity);
+    check(name, "nothing is presented while stuck", fake_display.presents == 0);
+
+    fake_display.held = false;
+    main_thread.join();
+    check(name, "the next one blocks until a slot frees", submitted == capacity + 1 && last_block_time >= (int64_t)SDL_GetPerformanceFrequency() * 40 / 1000);
+    PresentQueueDrain(queue);
+    check(name, "every frame is presented", fake_display.presents == capacity + 1);
+    DestroyPresentQueue(queue);
+}
+
+static void test_drain() {
+    const char* name = "drain";
+    reset_fake_display();
+    PresentQueue* queue = CreatePresentQueue(2, fake_present, NULL);
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    PresentQueueDrain(queue);
+    check(name, "returns at once with nothing queued", SDL_GetPerformanceCounter() - start < SDL_GetPerformanceFrequency() / 100);
+
+    fake_display.held = true;
+    PresentQueueFrame frame = { 1, 1 };
+    PresentQueueSubmit(queue, &frame);
+    PresentQueueSubmit(queue, &frame);
+    std::atomic<bool> drained(false);
+    std::thread drain_thread([&] {
+        PresentQueueDrain(queue);
+        drained = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    check(name, "waits while a frame is being presented", !drained);
+
+    fake_display.held = false;
+    drain_thread.join();
+    PresentQueueTimings timings;
+    PresentQueueReadTimings(queue, &timings);
+    check(name, "returns once every frame is presented", drained && fake_display.presents == 2 && timings.frames_presented == 2);
+
+    //a present nobody waited for leaves the event set, a later drain must still wait for its own frame
+    PresentQueueSubmit(queue, &frame);
+    while(fake_display.presents < 3) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10)); //the event is set right after the callback returns
+    fake_display.held = true;
+    PresentQueueSubmit(queue, &frame);
+    drained = false;
+    std::thread stale_thread([&] {
+        PresentQueueDrain(queue);
+        drained = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(30));
+    check(name, "a stale wakeup doesnt end the wait", !drained);
+    fake_display.held = false;
+    stale_thread.join();
+    check(name, "and it still returns", drained && fake_display.presents == 4);
+    DestroyPresentQueue(queue);
+}
+
+int main(int argc, char* argv[]) {
+    test_timings();
+    test_back_pressure();
+    test_drain();
+
+    printf(failures?"%d check(s) failed\n":"all checks passed\n", failures);
+    return failures?1:0;
+}
@@ -0,0 +1,242 @@
+//cpu side checks for QuadBatch: the structure-of-arrays packing, and the renderers region / fence rotation against a fake GL
+//the fake only stands in for the buffer and sync entry points QuadBatch.cpp loads itself, buffers are plain memory and every
+//fence reports signaled after a set number of polls, so no context or gpu is needed
+//
+//build (the renderer source is included below, with its function lookups pointed at the fake):
+//  cl /std:c++17 /EHsc /I. tests\QuadBatchTest.cpp SDL3.lib opengl32.lib
+//returns non zero if anything failed
+#include <SDL3/SDL.h>
+#include <SDL3/SDL_opengl.h>
+#include <cstdio>
+#include <cstdint>
+
+static void* test_gl_get_proc_address(const char* name);
+#define SDL_GL_GetProcAddress test_gl_get_proc_address
+#include "../QuadBatch.cpp"
+#undef SDL_GL_GetProcAddress
+
+struct FakeGL {
+    bool has_buffer_storage;
+    bool has_delete_buffers;
+
+    char* storage;
+    GLsizeiptr storage_size;
+    int buffer_data_calls; //every one after the first is an orphan
+    int buffers_generated;
+    int buffers_deleted;
+
+    static const int max_fences = 64;
+    int fence_polls_left[max_fences]; //polls until the fence reports signaled
+    bool fence_deleted[max_fences];
+    int fence_count;
+    int polls_to_signal; //for new fences
+    int blocked_polls; //ClientWaitSync calls that found the fence not signaled yet
+} fake_gl;
+
+static int fence_index(GLsync sync) {
+    return (int)(intptr_t)sync - 1;
+}
+
+static void APIENTRY fake_gen_buffers(GLsizei count, GLuint* buffers) {
+    for(int i = 0; i < count; i++) buffers[i] = ++fake_gl.buffers_generated;
+}
+static void APIENTRY fake_delete_buffers(GLsizei count, const GLuint* buffers) {
+    fake_gl.buffers_deleted += count;
+}
+static void APIENTRY fake_bind_buffer(GLenum target, GLuint buffer) {
+}
+static void resize_storage(GLsizeiptr size) {
+    free(fake_gl.storage);
+    fake_gl.storage = (char*)malloc(size);
+    memset(fake_gl.storage, 0, size);
+    fake_gl.storage_size = size;
+}
+static void APIENTRY fake_buffer_data(GLenum target, GLsizeiptr size, const void* data, GLenum usage) {
+    fake_gl.buffer_data_calls++;
+    resize_storage(size);
+}
+static void APIENTRY fake_buffer_storage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags) {
+    resize_storage(size);
+}
+static void* APIENTRY fake_map_buffer_range(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access) {
+    if(offset + length > fake_gl.storage_size) return NULL;
+    return fake_gl.storage + offset;
+}
+static GLboolean APIENTRY fake_unmap_buffer(GLenum target) {
+    return GL_TRUE;
+}
+static GLsync APIENTRY fake_fence_sync(GLenum condition, GLbitfield flags) {
+    int i = fake_gl.fence_count++;
+    fake_gl.fence_polls_left[i] = fake_gl.polls_to_signal;
+    return (GLsync)(intptr_t)(i + 1);
+}
+static GLenum APIENTRY fake_client_wait_sync(GLsync sync, GLbitfield flags, GLuint64 timeout) {
+    int i = fence_index(sync);
+    if(fake_gl.fence_polls_left[i] == 0) return GL_ALREADY_SIGNALED;
+    fake_gl.blocked_polls++;
+    return --fake_gl.fence_polls_left[i] == 0?GL_CONDITION_SATISFIED:GL_TIMEOUT_EXPIRED;
+}
+static void APIENTRY fake_delete_sync(GLsync sync) {
+    fake_gl.fence_deleted[fence_index(sync)] = true;
+}
+
+static void* test_gl_get_proc_address(const char* name) {
+    if(strcmp(name, "glGenBuffers") == 0) return (void*)fake_gen_buffers;
+    if(strcmp(name, "glDeleteBuffers") == 0) return fake_gl.has_delete_buffers?(void*)fake_delete_buffers:NULL;
+    if(strcmp(name, "glBindBuffer") == 0) return (void*)fake_bind_buffer;
+    if(strcmp(name, "glBufferData") == 0) return (void*)fake_buffer_data;
+    if(strcmp(name, "glBufferStorage") == 0) return fake_gl.has_buffer_storage?(void*)fake_buffer_storage:NULL;
+    if(strcmp(name, "glMapBufferRange") == 0) return (void*)fake_map_buffer_range;
+    if(strcmp(name, "glUnmapBuffer") == 0) return (void*)fake_unmap_buffer;
+    if(strcmp(name, "glFenceSync") == 0) return (void*)fake_fence_sync;
+    if(strcmp(name, "glClientWaitSync") == 0) return (void*)fake_client_wait_sync;
+    if(strcmp(name, "glDeleteSync") == 0) return (void*)fake_delete_sync;
+    return NULL;
+}
+
+static void reset_fake_gl(bool has_buffer_storage) {
+    free(fake_gl.storage);
+    memset(&fake_gl, 0, sizeof(fake_gl));
+    fake_gl.has_buffer_storage = has_buffer_storage;
+    fake_gl.has_delete_buffers = true;
+    fake_gl.polls_to_signal = 2;
+}
+
+static int failures;
+
+static void check(const char* name, const char* what, bool ok) {
+    printf("%s %-12s %s\n", ok?"ok  ":"FAIL", name, what);
+    if(!ok) failures++;
+}
+
+static void fill_batch(QuadBatch* batch, int count) {
+    QuadBatchClear(batch);
+    for(int i = 0; i < count; i++) QuadBatchPush(batch, (float)i, (float)(2*i), 10.0f + i, 20.0f + i, 0x01010101u * (Uint32)i);
+}
+
+//positions and colors of rects [first, first+count) as QuadBatchWriteVertices lays them out, checked value by value
+static bool vertices_match(const QuadBatch* batch, int first, int count, const float* positions, const Uint32* colors) {
+    for(int i = 0; i < count; i++) {
+        int r = first + i;
+        float x0 = batch->x[r], y0 = batch->y[r], x1 = x0 + batch->w[r], y1 = y0 + batch->h[r];
+        float expected[8] = { x0, y0, x1, y0, x1, y1, x0, y1 };
+        if(memcmp(positions + i*8, expected, sizeof(expected)) != 0) return false;
+        for(int v = 0; v < 4; v++) {
+            if(colors[i*4 + v] != batch->color[r]) return false;
+        }
+    }
+    return true;
+}
+
+static void test_packing() {
+    const char* name = "packing";
+    QuadBatch batch;
+    QuadBatchInit(&batch, 3);
+    fill_batch(&batch, 3);
+    check(name, "push past capacity is refused", !QuadBatchPush(&batch, 0, 0, 1, 1, 0) && batch.count == 3);
+    check(name, "color is RGBA8 with r in the low byte", QuadBatchColor(1, 0, .5f, 1) == 0xff8000ffu);
+    check(name, "colors clamp to 0..1", QuadBatchColor(-1, 2, 0, 1) == 0xff00ff00u);
+
+    float positions[3*8];
+    Uint32 colors[3*4];
+    QuadBatchWriteVertices(&batch, 0, 3, positions, colors);
+    check(name, "whole batch expands to GL_QUADS corners", vertices_match(&batch, 0, 3, positions, colors));
+    QuadBatchWriteVertices(&batch, 1, 2, positions, colors);
+    check(name, "partial range starts at first", vertices_match(&batch, 1, 2, positions, colors));
+    QuadBatchFree(&batch);
+}
+
+static void test_region_rotation() {
+    const char* name = "rotation";
+    reset_fake_gl(true);
+    QuadBatchRenderer* renderer = CreateQuadBatchRenderer(4);
+    check(name, "persistent with buffer storage", QuadBatchRendererIsPersistent(renderer));
+    check(name, "region is positions then colors", renderer->region_size == 4*8*(GLsizeiptr)sizeof(float) + 4*4*(GLsizeiptr)sizeof(Uint32));
+    check(name, "one mapping covers every region", fake_gl.storage_size == renderer->region_size * quad_batch_region_count);
+
+    //a region comes back once per quad_batch_region_count flushes, and only after the fence placed behind its last draw signaled
+    bool offsets_ok = true, fences_ok = true, no_early_wait = true;
+    for(int flush = 0; flush < 3 * quad_batch_region_count + 1; flush++) {
+        int blocked_before = fake_gl.blocked_polls;
+        GLintptr offset;
+        char* region = acquire_region(renderer, &offset);
+        int slot = flush % quad_batch_region_count;
+        if(offset != renderer->region_size * slot || region != fake_gl.storage + offset) offsets_ok = false;
+
+        if(flush < quad_batch_region_count) {
+            if(fake_gl.blocked_polls != blocked_before) no_early_wait = false; //nothing in flight yet
+        } else {
+            int reused = flush - quad_batch_region_count; //fence placed behind the draw that last read this region
+            if(fake_gl.fence_polls_left[reused] != 0 || !fake_gl.fence_deleted[reused]) fences_ok = false;
+            if(fake_gl.fence_deleted[reused + 1]) fences_ok = false; //the next region is still in flight, its fence is left alone
+        }
+        release_region(renderer);
+    }
+    check(name, "regions are handed out in order", offsets_ok);
+    check(name, "first use of each region never waits", no_early_wait);
+    check(name, "reuse waits for that regions fence only", fences_ok);
+    check(name, "waits poll until the fence signals", fake_gl.blocked_polls == 2 * (2 * quad_batch_region_count + 1));
+
+    DestroyQuadBatchRenderer(renderer);
+    bool all_deleted = true;
+    for(int i = 0; i < fake_gl.fence_count; i++) all_deleted = all_deleted && fake_gl.fence_deleted[i];
+    check(name, "destroy deletes the fences in flight", all_deleted);
+    check(name, "destroy deletes the buffer", fake_gl.buffers_deleted == 1);
+}
+
+static void test_flush_chunks() {
+    const char* name = "chunks";
+    reset_fake_gl(true);
+    fake_gl.polls_to_signal = 0;
+    QuadBatchRenderer* renderer = CreateQuadBatchRenderer(4);
+    QuadBatch batch;
+    QuadBatchInit(&batch, 16);
+    fill_batch(&batch, 10);
+
+    //10 rects at 4 per flush: 3 draws, each into the next region, the last one partly filled
+    QuadBatchRendererFlush(renderer, &batch);
+    bool contents_ok = true;
+    for(int chunk = 0; chunk < 3; chunk++) {
+        char* region = fake_gl.storage + renderer->region_size * chunk;
+        int count = chunk < 2?4:2;
+        if(!vertices_match(&batch, chunk * 4, count, (float*)region, (Uint32*)(region + renderer->color_offset))) contents_ok = false;
+    }
+    check(name, "each chunk lands in its own region", contents_ok);
+    check(name, "one fence per draw", fake_gl.fence_count == 3);
+    check(name, "flush clears the batch", batch.count == 0);
+
+    QuadBatchFree(&batch);
+    DestroyQuadBatchRenderer(renderer);
+}
+
+static void test_orphaning() {
+    const char* name = "orphaning";
+    reset_fake_gl(false);
+    QuadBatchRenderer* renderer = CreateQuadBatchRenderer(4);
+    check(name, "falls back without buffer storage", renderer && !QuadBatchRendererIsPersistent(renderer));
+    check(name, "one region, sized for one flush", fake_gl.storage_size == renderer->region_size);
+
+    bool offsets_ok = true;
+    for(int flush = 0; flush < 4; flush++) {
+        GLintptr offset;
+        if(!acquire_region(renderer, &offset) || offset != 0) offsets_ok = false;
+        release_region(renderer);
+    }
+    check(name, "every flush orphans and writes at 0", offsets_ok && fake_gl.buffer_data_calls == 1 + 4);
+    check(name, "no fences", fake_gl.fence_count == 0);
+    DestroyQuadBatchRenderer(renderer);
+
+    reset_fake_gl(false);
+    fake_gl.has_delete_buffers = false;
+    check(name, "refuses to start without glDeleteBuffers", CreateQuadBatchRenderer(4) == NULL);
+}
+
+int main(int argc, char* argv[]) {
+    test_packing();
+    test_region_rotation();
+    test_flush_chunks();
+    test_orphaning();
+
+    printf(failures?"%d check(s) failed\n":"all checks passed\n", failures);
+    return failures?1:0;
+}
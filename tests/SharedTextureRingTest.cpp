@@ -0,0 +1,61 @@
+//checks for SharedTextureRing: slots wrap in order, the slot handed to the copy is never the one rendered into next (for 2+ slots),
+//acquiring again without a submit doesnt move on to a slot whose copy may still be running, and count is clamped
+//
+//build:
+//  cl /std:c++17 /EHsc /O2 /I. tests\SharedTextureRingTest.cpp SharedTextureRing.cpp
+//returns non zero if anything failed
+#include "../SharedTextureRing.h"
+#include <cstdio>
+
+static int failures;
+
+static void check(const char* name, const char* what, bool ok) {
+    printf("%s %-12s %s\n", ok?"ok  ":"FAIL", name, what);
+    if(!ok) failures++;
+}
+
+static void test_ring(const char* name, int count) {
+    SharedTextureRing ring;
+    SharedTextureRingInit(&ring, count);
+    check(name, "nothing presented before the first submit", ring.count == count && ring.present_slot == -1);
+
+    //empty ring: the first frame renders into slot 0
+    check(name, "first acquire is slot 0", SharedTextureRingAcquire(&ring) == 0);
+
+    //three times around, every frame gets the slot after the last submitted and hands exactly that one to the copy
+    bool in_order = true, apart = true, submit_ok = true;
+    for(int frame = 0; frame < 3 * count; frame++) {
+        int slot = frame == 0?ring.render_slot:SharedTextureRingAcquire(&ring);
+        if(slot != frame % count) in_order = false;
+        if(slot == ring.present_slot) apart = false; //would render over the texture the copy is reading
+        if(SharedTextureRingSubmit(&ring) != slot || ring.present_slot != slot) submit_ok = false;
+    }
+    check(name, "slots wrap around in order", in_order);
+    check(name, "never renders into the slot in flight", apart);
+    check(name, "submit hands over the rendered slot", submit_ok);
+
+    //full: a frame acquired but not submitted (skipped present) keeps its slot, acquiring again doesnt step onto the next one
+    int slot = SharedTextureRingAcquire(&ring);
+    check(name, "acquire without submit keeps the slot", SharedTextureRingAcquire(&ring) == slot && slot != ring.present_slot);
+    SharedTextureRingSubmit(&ring);
+    check(name, "and the next submit moves on from it", SharedTextureRingAcquire(&ring) == (slot + 1) % count);
+}
+
+static void test_clamp() {
+    const char* name = "clamp";
+    SharedTextureRing ring;
+    SharedTextureRingInit(&ring, 0);
+    check(name, "at least one slot", ring.count == 1);
+    check(name, "a single slot is reused every frame", SharedTextureRingAcquire(&ring) == 0 && SharedTextureRingSubmit(&ring) == 0 && SharedTextureRingAcquire(&ring) == 0);
+    SharedTextureRingInit(&ring, SharedTextureRing::max_slots + 5);
+    check(name, "at most max_slots", ring.count == SharedTextureRing::max_slots);
+}
+
+int main(int argc, char* argv[]) {
+    test_ring("2 slots", 2);
+    test_ring("3 slots", 3);
+    test_clamp();
+
+    printf(failures?"%d check(s) failed\n":"all checks passed\n", failures);
+    return failures?1:0;
+}
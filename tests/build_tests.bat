@@ -0,0 +1,39 @@
+@echo off
+rem builds every test in tests\ and runs it, the build lines are the ones at the top of each test
+rem run it from the repo root in a developer command prompt, with SDL3 on INCLUDE / LIB and SDL3.dll on PATH
+rem returns non zero if a test didnt build or failed a check. binaries and build logs go to tests\bin
+setlocal
+if not exist tests\bin mkdir tests\bin
+set failed=0
+
+set pacer=DXGISwapChainAdapter.cpp DisplayProfileCache.cpp DriftWindow.cpp FixedUpdatePool.cpp FrameTrace.cpp PresentQueue.cpp QuadBatch.cpp SharedTextureRing.cpp VsyncEstimator.cpp SDL3.lib opengl32.lib d3d11.lib dxgi.lib
+
+call :run_test FramePacingTest "%pacer% FrameRecorder.cpp"
+call :run_test GpuTimingTest "%pacer% FrameRecorder.cpp"
+call :run_test FrameRecorderTest "%pacer%"
+call :run_test PresentQueueTest "DisplayProfileCache.cpp DriftWindow.cpp FixedUpdatePool.cpp FrameRecorder.cpp FrameTrace.cpp PresentQueue.cpp QuadBatch.cpp VsyncEstimator.cpp SDL3.lib opengl32.lib"
+call :run_test DXGISwapChainAdapterTest "DXGISwapChainAdapter.cpp FrameTrace.cpp PresentQueue.cpp SharedTextureRing.cpp VsyncEstimator.cpp SDL3.lib opengl32.lib d3d11.lib dxgi.lib"
+call :run_test SharedTextureRingTest "SharedTextureRing.cpp"
+call :run_test DisplayProfileCacheTest "DisplayProfileCache.cpp SDL3.lib"
+call :run_test FixedUpdatePoolTest "FixedUpdatePool.cpp FrameTrace.cpp SDL3.lib"
+call :run_test QuadBatchTest "SDL3.lib opengl32.lib"
+
+if %failed% neq 0 (
+    echo %failed% test^(s^) failed
+    exit /b 1
+)
+echo all tests passed
+exit /b 0
+
+rem name, then the sources and libraries it builds with besides tests\name.cpp
+:run_test
+echo == %1
+cl /nologo /std:c++17 /EHsc /O2 /I. /Fotests\bin\ /Fetests\bin\%1.exe tests\%1.cpp %~2 > tests\bin\%1.log
+if errorlevel 1 (
+    echo FAIL %1 didnt build, see tests\bin\%1.log
+    set /a failed+=1
+    exit /b
+)
+tests\bin\%1.exe
+if errorlevel 1 set /a failed+=1
+exit /b